@@ -0,0 +1,159 @@
+#include "../include/segtree.hpp"
+#include "../include/segment_tree.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/*
+ * Compares range-sum queries and point updates through the C library, the
+ * segtree::tree template and a hand-written bottom-up loop on the same
+ * layout. One JSON object per implementation.
+ */
+
+namespace {
+
+struct hand_written {
+    std::vector<int> nodes;
+    int capacity = 1;
+
+    explicit hand_written(const std::vector<int> &values) {
+        int n = static_cast<int>(values.size());
+        while (capacity < n) {
+            capacity *= 2;
+        }
+        nodes.assign(2 * capacity, 0);
+        std::memcpy(nodes.data() + capacity, values.data(), n * sizeof(int));
+        for (int node = capacity - 1; node >= 1; node--) {
+            nodes[node] = nodes[2 * node] + nodes[2 * node + 1];
+        }
+    }
+
+    int query(int left, int right) const {
+        int result = 0;
+        for (int l = left + capacity, r = right + capacity + 1; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                result += nodes[l++];
+            }
+            if (r & 1) {
+                result += nodes[--r];
+            }
+        }
+        return result;
+    }
+
+    void update_point(int index, int value) {
+        int node = index + capacity;
+        nodes[node] = value;
+        for (node >>= 1; node >= 1; node >>= 1) {
+            nodes[node] = nodes[2 * node] + nodes[2 * node + 1];
+        }
+    }
+};
+
+struct op_t {
+    bool read;
+    int left;
+    int right;
+    int value;
+};
+
+uint64_t rng_next(uint64_t &state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+template <class Body>
+void run(const char *impl, int n, const std::vector<op_t> &ops, Body body) {
+    unsigned int checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const op_t &op : ops) {
+        checksum += body(op);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("{\"impl\":\"%s\",\"n\":%d,\"ops\":%zu,\"ops_per_sec\":%.0f,\"ns_per_op\":%.1f,\"checksum\":%u}\n",
+                impl, n, ops.size(), ops.size() / seconds, seconds * 1e9 / ops.size(), checksum);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int n = 1000000;
+    int count = 2000000;
+    double read_ratio = 0.9;
+    uint64_t seed = 42;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--n") == 0) {
+            n = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--ops") == 0) {
+            count = std::atoi(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--read-ratio") == 0) {
+            read_ratio = std::atof(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "usage: %s [--n N] [--ops K] [--read-ratio R] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (n <= 0 || count <= 0) {
+        std::fprintf(stderr, "n and ops must be positive\n");
+        return 1;
+    }
+
+    uint64_t state = seed;
+    std::vector<int> values(n);
+    for (int &v : values) {
+        v = static_cast<int>(rng_next(state) % 1000);
+    }
+
+    std::vector<op_t> ops(count);
+    for (op_t &op : ops) {
+        int a = static_cast<int>(rng_next(state) % n);
+        int b = static_cast<int>(rng_next(state) % n);
+        op.read = (rng_next(state) >> 11) * (1.0 / 9007199254740992.0) < read_ratio;
+        op.left = a < b ? a : b;
+        op.right = a < b ? b : a;
+        op.value = static_cast<int>(rng_next(state) % 1000);
+    }
+
+    segment_tree_t *st = segtree_create(values.data(), n, SEGTREE_SUM);
+    run("c_library", n, ops, [st](const op_t &op) -> unsigned int {
+        if (op.read) {
+            int result;
+            segtree_query(st, op.left, op.right, &result);
+            return static_cast<unsigned int>(result);
+        }
+        segtree_update_point(st, op.left, op.value);
+        return 0;
+    });
+    segtree_destroy(st);
+
+    segtree::tree<int> tree(values);
+    run("cpp_template", n, ops, [&tree](const op_t &op) -> unsigned int {
+        if (op.read) {
+            return static_cast<unsigned int>(tree.query(op.left, op.right));
+        }
+        tree.update_point(op.left, op.value);
+        return 0;
+    });
+
+    hand_written hand(values);
+    run("hand_written", n, ops, [&hand](const op_t &op) -> unsigned int {
+        if (op.read) {
+            return static_cast<unsigned int>(hand.query(op.left, op.right));
+        }
+        hand.update_point(op.left, op.value);
+        return 0;
+    });
+
+    return 0;
+}
@@ -0,0 +1,364 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "../include/segment_tree.h"
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef enum {
+    DIST_UNIFORM,
+    DIST_ZIPF
+} range_dist_t;
+
+typedef struct {
+    int n;
+    int ops;
+    segtree_operation_t op;
+    bool lazy;
+    range_dist_t dist;
+    double zipf_s;
+    double read_ratio;
+    uint64_t seed;
+} bench_config_t;
+
+typedef struct {
+    int kind;
+    int left;
+    int right;
+    int value;
+} bench_op_t;
+
+typedef struct {
+    uint64_t state;
+} bench_rng_t;
+
+typedef struct {
+    double s;
+    double n;
+    double h_integral_x1;
+    double h_integral_n;
+    double threshold;
+} zipf_t;
+
+static uint64_t rng_next(bench_rng_t *rng) {
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static double rng_uniform(bench_rng_t *rng) {
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int rng_below(bench_rng_t *rng, int bound) {
+    return (int)(rng_next(rng) % (uint64_t)bound);
+}
+
+/* Rejection-inversion Zipf sampler (Hormann & Derflinger): O(1) setup, so
+ * it works for n up to 10^8 without a CDF table. */
+static double zipf_helper1(double x) {
+    return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static double zipf_helper2(double x) {
+    return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+static double zipf_h(const zipf_t *z, double x) {
+    return exp(-z->s * log(x));
+}
+
+static double zipf_h_integral(const zipf_t *z, double x) {
+    double log_x = log(x);
+    return zipf_helper2((1.0 - z->s) * log_x) * log_x;
+}
+
+static double zipf_h_integral_inverse(const zipf_t *z, double x) {
+    double t = x * (1.0 - z->s);
+    if (t < -1.0) {
+        t = -1.0;
+    }
+    return exp(zipf_helper1(t) * x);
+}
+
+static void zipf_init(zipf_t *z, int n, double s) {
+    z->s = s;
+    z->n = n;
+    z->h_integral_x1 = zipf_h_integral(z, 1.5) - 1.0;
+    z->h_integral_n = zipf_h_integral(z, n + 0.5);
+    z->threshold = 2.0 - zipf_h_integral_inverse(z, zipf_h_integral(z, 2.5) - zipf_h(z, 2.0));
+}
+
+static int zipf_sample(const zipf_t *z, bench_rng_t *rng) {
+    for (;;) {
+        double u = z->h_integral_n + rng_uniform(rng) * (z->h_integral_x1 - z->h_integral_n);
+        double x = zipf_h_integral_inverse(z, u);
+        double k = floor(x + 0.5);
+
+        if (k < 1.0) {
+            k = 1.0;
+        } else if (k > z->n) {
+            k = z->n;
+        }
+
+        if (k - x <= z->threshold || u >= zipf_h_integral(z, k + 0.5) - zipf_h(z, k)) {
+            return (int)k;
+        }
+    }
+}
+
+static void generate_range(const bench_config_t *cfg, bench_rng_t *rng, int *left, int *right) {
+    if (cfg->dist == DIST_ZIPF) {
+        /* Hot ranges are short and near the end of the array (recent data). */
+        zipf_t pos;
+        zipf_init(&pos, cfg->n, cfg->zipf_s);
+        *left = cfg->n - zipf_sample(&pos, rng);
+
+        zipf_t len;
+        zipf_init(&len, cfg->n - *left, cfg->zipf_s);
+        *right = *left + zipf_sample(&len, rng) - 1;
+    } else {
+        int a = rng_below(rng, cfg->n);
+        int b = rng_below(rng, cfg->n);
+        *left = a < b ? a : b;
+        *right = a < b ? b : a;
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t percentile(const uint64_t *sorted, int count, double p) {
+    if (count == 0) {
+        return 0;
+    }
+    int idx = (int)ceil(p * count) - 1;
+    if (idx < 0) {
+        idx = 0;
+    }
+    return sorted[idx];
+}
+
+static void print_latency(const char *name, uint64_t *samples, int count) {
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+
+    double mean = 0.0;
+    for (int i = 0; i < count; i++) {
+        mean += (double)samples[i];
+    }
+    if (count > 0) {
+        mean /= count;
+    }
+
+    printf("\"%s\":{\"count\":%d,\"mean_ns\":%.1f,\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}",
+           name, count, mean,
+           (unsigned long long)percentile(samples, count, 0.50),
+           (unsigned long long)percentile(samples, count, 0.99),
+           (unsigned long long)percentile(samples, count, 0.999),
+           (unsigned long long)(count > 0 ? samples[count - 1] : 0));
+}
+
+static const char* op_name(segtree_operation_t op) {
+    switch (op) {
+        case SEGTREE_MIN:
+            return "min";
+        case SEGTREE_MAX:
+            return "max";
+        default:
+            return "sum";
+    }
+}
+
+static segtree_error_t run_op(segment_tree_t *st, const bench_op_t *op, unsigned int *sink) {
+    if (op->kind == 0) {
+        int result;
+        segtree_error_t error = segtree_query(st, op->left, op->right, &result);
+        *sink += (unsigned int)result;
+        return error;
+    }
+
+    if (st->lazy_enabled) {
+        return segtree_update_range(st, op->left, op->right, op->value);
+    }
+    return segtree_update_point(st, op->left, op->value);
+}
+
+static int run_bench(const bench_config_t *cfg) {
+    bench_rng_t rng = {cfg->seed};
+
+    int *arr = (int*)malloc((size_t)cfg->n * sizeof(int));
+    bench_op_t *ops = (bench_op_t*)malloc((size_t)cfg->ops * sizeof(bench_op_t));
+    uint64_t *query_ns = (uint64_t*)malloc((size_t)cfg->ops * sizeof(uint64_t));
+    uint64_t *update_ns = (uint64_t*)malloc((size_t)cfg->ops * sizeof(uint64_t));
+    if (arr == NULL || ops == NULL || query_ns == NULL || update_ns == NULL) {
+        fprintf(stderr, "bench: out of memory\n");
+        free(arr);
+        free(ops);
+        free(query_ns);
+        free(update_ns);
+        return 1;
+    }
+
+    for (int i = 0; i < cfg->n; i++) {
+        arr[i] = rng_below(&rng, 1000);
+    }
+
+    for (int i = 0; i < cfg->ops; i++) {
+        ops[i].kind = rng_uniform(&rng) < cfg->read_ratio ? 0 : 1;
+        generate_range(cfg, &rng, &ops[i].left, &ops[i].right);
+        ops[i].value = rng_below(&rng, 17) - 8;
+    }
+
+    uint64_t build_start = now_ns();
+    segment_tree_t *st = cfg->lazy ? segtree_create_lazy(arr, cfg->n, cfg->op)
+                                   : segtree_create(arr, cfg->n, cfg->op);
+    uint64_t build_ns = now_ns() - build_start;
+    if (st == NULL) {
+        fprintf(stderr, "bench: failed to create tree with n=%d\n", cfg->n);
+        free(arr);
+        free(ops);
+        free(query_ns);
+        free(update_ns);
+        return 1;
+    }
+
+    unsigned int sink = 0;
+
+    /* Throughput pass without per-operation timers. */
+    uint64_t pass_start = now_ns();
+    for (int i = 0; i < cfg->ops; i++) {
+        run_op(st, &ops[i], &sink);
+    }
+    uint64_t pass_ns = now_ns() - pass_start;
+
+    /* Latency pass over the same operation stream. */
+    int queries = 0;
+    int updates = 0;
+    for (int i = 0; i < cfg->ops; i++) {
+        uint64_t t0 = now_ns();
+        run_op(st, &ops[i], &sink);
+        uint64_t elapsed = now_ns() - t0;
+
+        if (ops[i].kind == 0) {
+            query_ns[queries++] = elapsed;
+        } else {
+            update_ns[updates++] = elapsed;
+        }
+    }
+
+    /* Replay the reads through the interleaved batch API. */
+    int *lefts = (int*)malloc((size_t)queries * sizeof(int) + 1);
+    int *rights = (int*)malloc((size_t)queries * sizeof(int) + 1);
+    int *results = (int*)malloc((size_t)queries * sizeof(int) + 1);
+    uint64_t batch_ns = 0;
+    if (lefts != NULL && rights != NULL && results != NULL) {
+        int q = 0;
+        for (int i = 0; i < cfg->ops; i++) {
+            if (ops[i].kind == 0) {
+                lefts[q] = ops[i].left;
+                rights[q] = ops[i].right;
+                q++;
+            }
+        }
+
+        uint64_t batch_start = now_ns();
+        segtree_query_batch(st, lefts, rights, results, q);
+        batch_ns = now_ns() - batch_start;
+
+        for (int i = 0; i < q; i++) {
+            sink += (unsigned int)results[i];
+        }
+    }
+    free(lefts);
+    free(rights);
+    free(results);
+
+    printf("{\"n\":%d,\"ops\":%d,\"op\":\"%s\",\"lazy\":%s,\"dist\":\"%s\",\"zipf_s\":%.3f,"
+           "\"read_ratio\":%.3f,\"seed\":%llu,\"build_ns\":%llu,\"throughput_ops_per_sec\":%.1f,"
+           "\"batch_query_ops_per_sec\":%.1f,",
+           cfg->n, cfg->ops, op_name(cfg->op), cfg->lazy ? "true" : "false",
+           cfg->dist == DIST_ZIPF ? "zipf" : "uniform", cfg->zipf_s, cfg->read_ratio,
+           (unsigned long long)cfg->seed, (unsigned long long)build_ns,
+           pass_ns > 0 ? cfg->ops * 1e9 / (double)pass_ns : 0.0,
+           batch_ns > 0 ? queries * 1e9 / (double)batch_ns : 0.0);
+    print_latency("query", query_ns, queries);
+    printf(",");
+    print_latency(cfg->lazy ? "update_range" : "update_point", update_ns, updates);
+    printf(",\"checksum\":%u}\n", sink);
+
+    segtree_destroy(st);
+    free(arr);
+    free(ops);
+    free(query_ns);
+    free(update_ns);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --n N             array size (default 1000000, up to %d)\n"
+            "  --ops N           operations per pass (default 1000000)\n"
+            "  --op sum|min|max  aggregate (default sum)\n"
+            "  --lazy 0|1        lazy tree with range updates (default 0)\n"
+            "  --dist uniform|zipf  range distribution (default uniform)\n"
+            "  --zipf-s S        Zipf exponent (default 1.1)\n"
+            "  --read-ratio R    fraction of queries in [0, 1] (default 0.9)\n"
+            "  --seed S          PRNG seed (default 42)\n",
+            prog, SEGTREE_MAX_SIZE);
+}
+
+int main(int argc, char **argv) {
+    bench_config_t cfg = {1000000, 1000000, SEGTREE_SUM, false, DIST_UNIFORM, 1.1, 0.9, 42};
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (val == NULL) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (strcmp(arg, "--n") == 0) {
+            cfg.n = (int)strtod(val, NULL);
+        } else if (strcmp(arg, "--ops") == 0) {
+            cfg.ops = (int)strtod(val, NULL);
+        } else if (strcmp(arg, "--op") == 0) {
+            cfg.op = strcmp(val, "min") == 0 ? SEGTREE_MIN
+                   : strcmp(val, "max") == 0 ? SEGTREE_MAX : SEGTREE_SUM;
+        } else if (strcmp(arg, "--lazy") == 0) {
+            cfg.lazy = atoi(val) != 0;
+        } else if (strcmp(arg, "--dist") == 0) {
+            cfg.dist = strcmp(val, "zipf") == 0 ? DIST_ZIPF : DIST_UNIFORM;
+        } else if (strcmp(arg, "--zipf-s") == 0) {
+            cfg.zipf_s = atof(val);
+        } else if (strcmp(arg, "--read-ratio") == 0) {
+            cfg.read_ratio = atof(val);
+        } else if (strcmp(arg, "--seed") == 0) {
+            cfg.seed = strtoull(val, NULL, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (cfg.n <= 0 || cfg.n > SEGTREE_MAX_SIZE || cfg.ops <= 0 ||
+        cfg.zipf_s <= 0.0 || cfg.read_ratio < 0.0 || cfg.read_ratio > 1.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    return run_bench(&cfg);
+}
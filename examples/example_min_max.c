@@ -130,9 +130,9 @@ int main() {
     segtree_stats_t min_stats = segtree_get_stats(min_st);
     segtree_stats_t max_stats = segtree_get_stats(max_st);
 
-    printf("MIN Tree - Queries: %d, Updates: %d\n",
+    printf("MIN Tree - Queries: %llu, Updates: %llu\n",
            min_stats.query_count, min_stats.update_count);
-    printf("MAX Tree - Queries: %d, Updates: %d\n",
+    printf("MAX Tree - Queries: %llu, Updates: %llu\n",
            max_stats.query_count, max_stats.update_count);
 
     segtree_destroy(min_st);
@@ -74,8 +74,8 @@ int main() {
 
     printf("\n=== Statistics ===\n");
     segtree_stats_t stats = segtree_get_stats(st);
-    printf("Total queries performed: %d\n", stats.query_count);
-    printf("Total updates performed: %d\n", stats.update_count);
+    printf("Total queries performed: %llu\n", stats.query_count);
+    printf("Total updates performed: %llu\n", stats.update_count);
     printf("Total query time: %.6f seconds\n", stats.total_query_time);
     printf("Total update time: %.6f seconds\n", stats.total_update_time);
 
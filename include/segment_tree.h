@@ -7,16 +7,31 @@
 #include <string.h>
 #include <time.h>
 
-#define SEGTREE_MAX_SIZE 1000000
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEGTREE_MAX_SIZE (1 << 27)
 #define SEGTREE_INF 2147483647
 #define SEGTREE_NEG_INF -2147483648
+#define SEGTREE_DIFF_FULL_REBUILD_RATIO 8
+#define SEGTREE_BATCH_GROUP 16
+#define SEGTREE_CACHE_EPOCH_BLOCKS 64
+#define SEGTREE_BULK_RANGE_COST 16
+#define SEGTREE_VALIDATE_MIN_NODES (1 << 16)
+#define SEGTREE_VALIDATE_MAX_THREADS 64
+#define SEGTREE_WAL_GROUP_DELAY_MS 10
+#define SEGTREE_HIST_SUB_BITS 4
+#define SEGTREE_HIST_MAX_BITS 40
+#define SEGTREE_HIST_BUCKETS ((SEGTREE_HIST_MAX_BITS - SEGTREE_HIST_SUB_BITS + 1) << SEGTREE_HIST_SUB_BITS)
 
 typedef enum {
     SEGTREE_OK = 0,
     SEGTREE_ERROR_NULL_POINTER,
     SEGTREE_ERROR_INVALID_RANGE,
     SEGTREE_ERROR_MEMORY_ALLOCATION,
-    SEGTREE_ERROR_INVALID_OPERATION
+    SEGTREE_ERROR_INVALID_OPERATION,
+    SEGTREE_ERROR_IO
 } segtree_error_t;
 
 typedef enum {
@@ -26,17 +41,113 @@ typedef enum {
     SEGTREE_CUSTOM
 } segtree_operation_t;
 
+typedef enum {
+    SEGTREE_PERF_QUERY,
+    SEGTREE_PERF_UPDATE_POINT,
+    SEGTREE_PERF_UPDATE_RANGE,
+    SEGTREE_PERF_BUILD,
+    SEGTREE_PERF_OP_COUNT
+} segtree_perf_op_t;
+
+typedef enum {
+    SEGTREE_TIE_LEFTMOST,
+    SEGTREE_TIE_RIGHTMOST
+} segtree_tie_t;
+
+typedef enum {
+    SEGTREE_BULK_NONE,
+    SEGTREE_BULK_LAZY,
+    SEGTREE_BULK_REBUILD
+} segtree_bulk_path_t;
+
+typedef enum {
+    SEGTREE_WAL_SYNC_NONE,
+    SEGTREE_WAL_SYNC_GROUP,
+    SEGTREE_WAL_SYNC_EACH
+} segtree_wal_sync_t;
+
 typedef struct {
-    int query_count;
-    int update_count;
+    unsigned long long samples;
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long l1d_misses;
+    unsigned long long llc_misses;
+    unsigned long long dtlb_misses;
+} segtree_perf_counters_t;
+
+typedef struct {
+    unsigned long long query_count;
+    unsigned long long update_count;
     double total_query_time;
     double total_update_time;
+    unsigned long long cache_hits;
+    unsigned long long cache_misses;
+    unsigned long long coalesced_writes;
+    unsigned long long buffer_flushes;
+    segtree_perf_counters_t perf[SEGTREE_PERF_OP_COUNT];
 } segtree_stats_t;
 
+/* Log-linear latency histogram in nanoseconds: values below
+ * 2^SEGTREE_HIST_SUB_BITS get exact buckets, and every power of two above
+ * that is split into 2^SEGTREE_HIST_SUB_BITS equal buckets. */
+typedef struct {
+    unsigned long long count;
+    unsigned long long sum_ns;
+    unsigned long long min_ns;
+    unsigned long long max_ns;
+    unsigned long long buckets[SEGTREE_HIST_BUCKETS];
+} segtree_histogram_t;
+
+typedef struct {
+    segtree_histogram_t ops[SEGTREE_PERF_OP_COUNT];
+} segtree_metrics_t;
+
+typedef enum {
+    SEGTREE_EXPORT_PROMETHEUS,
+    SEGTREE_EXPORT_JSON
+} segtree_export_format_t;
+
+typedef struct {
+    int left;
+    int right;
+} segtree_range_t;
+
+typedef struct {
+    int left;
+    int right;
+    int value;
+    unsigned int stamp;
+} segtree_cache_entry_t;
+
+typedef struct {
+    segtree_cache_entry_t *entries;
+    int mask;
+    int block_shift;
+    unsigned int clock;
+    unsigned int block_epoch[SEGTREE_CACHE_EPOCH_BLOCKS];
+} segtree_cache_t;
+
+typedef struct {
+    int *point_indices;
+    int *point_values;
+    int *slots;
+    int slot_mask;
+    int point_count;
+    int *range_lefts;
+    int *range_rights;
+    int *range_values;
+    int range_count;
+    int limit;
+} segtree_write_buffer_t;
+
+struct segtree_perf;
+struct segtree_wal;
+
 typedef struct segment_tree {
     int *tree;
     int *lazy;
     int size;
+    int capacity;
     int tree_size;
     segtree_operation_t op_type;
 
@@ -46,7 +157,12 @@ typedef struct segment_tree {
 
     int identity;
     bool lazy_enabled;
+    bool frequency_mode;
     segtree_stats_t stats;
+    struct segtree_perf *perf;
+    segtree_cache_t *cache;
+    segtree_write_buffer_t *write_buffer;
+    struct segtree_wal *wal;
 } segment_tree_t;
 
 segment_tree_t* segtree_create(int *arr, int n, segtree_operation_t op);
@@ -57,14 +173,83 @@ segment_tree_t* segtree_create_lazy(int *arr, int n, segtree_operation_t op);
 void segtree_destroy(segment_tree_t *st);
 
 segtree_error_t segtree_query(segment_tree_t *st, int left, int right, int *result);
+segtree_error_t segtree_query_arg(segment_tree_t *st, int left, int right, int *value, int *index,
+                                  segtree_tie_t tie);
+/* Frequency mode (SUM only): every leaf is a non-negative count, and updates
+ * that would make one negative fail with SEGTREE_ERROR_INVALID_OPERATION.
+ * The k-th and rank queries require it. */
+segtree_error_t segtree_set_frequency_mode(segment_tree_t *st, bool enabled);
+segtree_error_t segtree_kth(segment_tree_t *st, int k, int *index);
+segtree_error_t segtree_rank(segment_tree_t *st, int x, int *count);
+segtree_error_t segtree_kth_batch(segment_tree_t *st, const int *ks, int *indices, int count);
+segtree_error_t segtree_rank_batch(segment_tree_t *st, const int *xs, int *counts, int count);
+segtree_error_t segtree_query_batch(segment_tree_t *st, int *lefts, int *rights, int *results, int count);
+segtree_error_t segtree_query_offline(segment_tree_t *st, const segtree_range_t *ranges, int *results, int count);
 segtree_error_t segtree_update_point(segment_tree_t *st, int index, int value);
+segtree_error_t segtree_update_points(segment_tree_t *st, int *indices, int *values, int count);
 segtree_error_t segtree_update_range(segment_tree_t *st, int left, int right, int value);
+segtree_error_t segtree_update_ranges(segment_tree_t *st, int *lefts, int *rights, int *values, int count,
+                                      segtree_bulk_path_t *path);
 segtree_error_t segtree_rebuild(segment_tree_t *st, int *new_arr, int new_size);
+segtree_error_t segtree_rebuild_diff(segment_tree_t *st, int *new_arr, int n);
+segtree_error_t segtree_append(segment_tree_t *st, int value);
+segtree_error_t segtree_append_many(segment_tree_t *st, int *values, int count);
 
 void segtree_print(segment_tree_t *st);
 bool segtree_validate(segment_tree_t *st);
+bool segtree_validate_parallel(segment_tree_t *st, int threads);
+bool segtree_validate_sampled(segment_tree_t *st, int paths, unsigned int seed);
 segtree_stats_t segtree_get_stats(segment_tree_t *st);
 void segtree_reset_stats(segment_tree_t *st);
+void segtree_print_stats(segment_tree_t *st);
+
+segtree_error_t segtree_perf_enable(segment_tree_t *st);
+void segtree_perf_disable(segment_tree_t *st);
+void segtree_perf_begin(segment_tree_t *st);
+void segtree_perf_end(segment_tree_t *st, segtree_perf_op_t op);
+
+unsigned long long segtree_clock_ns(void);
+void segtree_histogram_record(segtree_histogram_t *hist, unsigned long long ns);
+void segtree_histogram_record_batch(segtree_histogram_t *hist, unsigned long long total_ns,
+                                    unsigned long long items);
+void segtree_histogram_merge(segtree_histogram_t *dst, const segtree_histogram_t *src);
+unsigned long long segtree_histogram_percentile(const segtree_histogram_t *hist, double percentile);
+void segtree_metrics_record(segtree_perf_op_t op, unsigned long long ns);
+void segtree_metrics_record_batch(segtree_perf_op_t op, unsigned long long total_ns, unsigned long long items);
+void segtree_metrics_local(segtree_metrics_t *out);
+void segtree_metrics_reset_local(void);
+void segtree_metrics_merge(segtree_metrics_t *dst, const segtree_metrics_t *src);
+void segtree_metrics_collect(segtree_metrics_t *out);
+segtree_error_t segtree_metrics_export(int fd, const segtree_metrics_t *metrics, segtree_export_format_t format);
+
+segtree_error_t segtree_cache_enable(segment_tree_t *st, int slots);
+void segtree_cache_disable(segment_tree_t *st);
+bool segtree_cache_lookup(segment_tree_t *st, int left, int right, int *result);
+void segtree_cache_store(segment_tree_t *st, int left, int right, int value);
+void segtree_cache_invalidate(segment_tree_t *st, int left, int right);
+void segtree_cache_invalidate_all(segment_tree_t *st);
+
+segtree_error_t segtree_write_buffer_enable(segment_tree_t *st, int limit);
+segtree_error_t segtree_write_buffer_disable(segment_tree_t *st);
+void segtree_write_buffer_discard(segment_tree_t *st);
+segtree_error_t segtree_write_buffer_add_point(segment_tree_t *st, int index, int value);
+segtree_error_t segtree_write_buffer_add_range(segment_tree_t *st, int left, int right, int value);
+segtree_error_t segtree_flush(segment_tree_t *st);
+
+segtree_error_t segtree_wal_enable(segment_tree_t *st, const char *log_path, const char *snapshot_path,
+                                   segtree_wal_sync_t sync, int group_records, long long checkpoint_records);
+void segtree_wal_disable(segment_tree_t *st);
+segtree_error_t segtree_wal_set_group_delay(segment_tree_t *st, int delay_ms);
+segtree_error_t segtree_wal_sync(segment_tree_t *st);
+segtree_error_t segtree_wal_checkpoint(segment_tree_t *st);
+segment_tree_t* segtree_wal_recover(const char *log_path, const char *snapshot_path,
+                                    segtree_wal_sync_t sync, int group_records, long long checkpoint_records);
+
+void segtree_build_bottom_up(segment_tree_t *st, int *arr, int n);
+void segtree_build_internal(segment_tree_t *st);
+void segtree_push_all(segment_tree_t *st);
+segtree_error_t segtree_frequency_check(segment_tree_t *st, const int *lefts, const int *rights,
+                                        const int *values, int count);
 
 int combine_sum(int a, int b);
 int combine_min(int a, int b);
@@ -78,4 +263,8 @@ void propagate_sum(segment_tree_t *st, int node, int start, int end);
 void propagate_min(segment_tree_t *st, int node, int start, int end);
 void propagate_max(segment_tree_t *st, int node, int start, int end);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
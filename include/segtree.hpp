@@ -0,0 +1,274 @@
+#ifndef SEGTREE_HPP
+#define SEGTREE_HPP
+
+/*
+ * Header-only C++20 front-end over the same capacity-aligned layout as
+ * segment_tree_t: leaf i at node capacity + i, children of k at 2k and 2k+1,
+ * and (with a lazy tag) tree[k] already includes lazy[k], which is pending
+ * for the children only. Monoid and tag operations are static constexpr
+ * members, so every combine is inlined.
+ */
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace segtree {
+
+template <class T>
+struct sum {
+    static constexpr T identity() { return T{}; }
+    static constexpr T combine(const T &a, const T &b) { return a + b; }
+};
+
+template <class T>
+struct min {
+    static constexpr T identity() { return std::numeric_limits<T>::max(); }
+    static constexpr T combine(const T &a, const T &b) { return b < a ? b : a; }
+};
+
+template <class T>
+struct max {
+    static constexpr T identity() { return std::numeric_limits<T>::lowest(); }
+    static constexpr T combine(const T &a, const T &b) { return a < b ? b : a; }
+};
+
+/* Default LazyTag: no range updates. */
+struct no_tag {};
+
+/* Range add on a sum tree: a node covering len leaves grows by tag * len. */
+template <class T>
+struct add_to_sum {
+    using tag_type = T;
+    static constexpr tag_type none() { return T{}; }
+    static constexpr T apply(const T &value, const tag_type &tag, std::size_t len) {
+        return value + tag * static_cast<T>(len);
+    }
+    static constexpr tag_type compose(const tag_type &older, const tag_type &newer) { return older + newer; }
+};
+
+/* Range add on a min or max tree. */
+template <class T>
+struct add_to_extreme {
+    using tag_type = T;
+    static constexpr tag_type none() { return T{}; }
+    static constexpr T apply(const T &value, const tag_type &tag, std::size_t) { return value + tag; }
+    static constexpr tag_type compose(const tag_type &older, const tag_type &newer) { return older + newer; }
+};
+
+/* Range assign on a min or max tree (what the C lazy MIN/MAX trees do). */
+template <class T>
+struct assign_to_extreme {
+    struct tag_type {
+        T value{};
+        bool set = false;
+        constexpr bool operator==(const tag_type &) const = default;
+    };
+    static constexpr tag_type none() { return tag_type{}; }
+    static constexpr T apply(const T &value, const tag_type &tag, std::size_t) { return tag.set ? tag.value : value; }
+    static constexpr tag_type compose(const tag_type &older, const tag_type &newer) { return newer.set ? newer : older; }
+};
+
+template <class T, class Monoid = sum<T>, class LazyTag = no_tag>
+class tree {
+    static constexpr bool lazy = !std::is_same_v<LazyTag, no_tag>;
+
+    template <class Tag, bool = lazy>
+    struct tag_of {
+        using type = char;
+    };
+    template <class Tag>
+    struct tag_of<Tag, true> {
+        using type = typename Tag::tag_type;
+    };
+
+public:
+    using value_type = T;
+    using tag_type = typename tag_of<LazyTag>::type;
+
+    explicit tree(std::size_t n) : tree(n, nullptr) {
+        for (std::size_t i = 0; i < capacity_; i++) {
+            nodes_[capacity_ + i] = Monoid::identity();
+        }
+        build_internal();
+    }
+
+    explicit tree(std::span<const T> values) : tree(values.size(), nullptr) {
+        for (std::size_t i = 0; i < capacity_; i++) {
+            nodes_[capacity_ + i] = i < size_ ? values[i] : Monoid::identity();
+        }
+        build_internal();
+    }
+
+    tree(const tree &) = delete;
+    tree &operator=(const tree &) = delete;
+
+    tree(tree &&other) noexcept
+        : nodes_(std::move(other.nodes_)), tags_(std::move(other.tags_)),
+          size_(std::exchange(other.size_, 0)), capacity_(std::exchange(other.capacity_, 0)),
+          height_(std::exchange(other.height_, 0)) {}
+
+    tree &operator=(tree &&other) noexcept {
+        nodes_ = std::move(other.nodes_);
+        tags_ = std::move(other.tags_);
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, 0);
+        height_ = std::exchange(other.height_, 0);
+        return *this;
+    }
+
+    ~tree() = default;
+
+    std::size_t size() const { return size_; }
+    std::size_t capacity() const { return capacity_; }
+
+    /* Aggregate of [left, right], inclusive like segtree_query. */
+    T query(std::size_t left, std::size_t right) const requires(!lazy) {
+        check_range(left, right);
+        return query_nodes(left + capacity_, right + capacity_ + 1);
+    }
+
+    T query(std::size_t left, std::size_t right) requires(lazy) {
+        check_range(left, right);
+        std::size_t l = left + capacity_;
+        std::size_t r = right + capacity_ + 1;
+        push_boundaries(l, r);
+        return query_nodes(l, r);
+    }
+
+    T get(std::size_t index) requires(lazy) { return query(index, index); }
+    T get(std::size_t index) const requires(!lazy) { return query(index, index); }
+
+    void update_point(std::size_t index, const T &value) {
+        if (index >= size_) {
+            throw std::out_of_range("segtree::tree::update_point");
+        }
+
+        std::size_t node = index + capacity_;
+        if constexpr (lazy) {
+            for (int h = height_; h >= 1; h--) {
+                push(node >> h, std::size_t{1} << h);
+            }
+        }
+
+        nodes_[node] = value;
+        for (node >>= 1; node >= 1; node >>= 1) {
+            nodes_[node] = Monoid::combine(nodes_[2 * node], nodes_[2 * node + 1]);
+        }
+    }
+
+    void update_range(std::size_t left, std::size_t right, const tag_type &tag) requires(lazy) {
+        check_range(left, right);
+
+        std::size_t l = left + capacity_;
+        std::size_t r = right + capacity_ + 1;
+        push_boundaries(l, r);
+
+        std::size_t len = 1;
+        for (std::size_t a = l, b = r; a < b; a >>= 1, b >>= 1, len <<= 1) {
+            if (a & 1) {
+                apply_node(a++, len, tag);
+            }
+            if (b & 1) {
+                apply_node(--b, len, tag);
+            }
+        }
+
+        for (int h = 1; h <= height_; h++) {
+            if (((l >> h) << h) != l) {
+                pull(l >> h);
+            }
+            if (((r >> h) << h) != r) {
+                pull((r - 1) >> h);
+            }
+        }
+    }
+
+private:
+    tree(std::size_t n, std::nullptr_t) : size_(n), capacity_(1), height_(0) {
+        if (n == 0) {
+            throw std::invalid_argument("segtree::tree: empty input");
+        }
+        while (capacity_ < n) {
+            capacity_ <<= 1;
+            height_++;
+        }
+        nodes_ = std::make_unique_for_overwrite<T[]>(2 * capacity_);
+        if constexpr (lazy) {
+            tags_ = std::make_unique_for_overwrite<tag_type[]>(capacity_);
+            for (std::size_t i = 0; i < capacity_; i++) {
+                tags_[i] = LazyTag::none();
+            }
+        }
+    }
+
+    void build_internal() {
+        for (std::size_t node = capacity_ - 1; node >= 1; node--) {
+            nodes_[node] = Monoid::combine(nodes_[2 * node], nodes_[2 * node + 1]);
+        }
+    }
+
+    void check_range(std::size_t left, std::size_t right) const {
+        if (left > right || right >= size_) {
+            throw std::out_of_range("segtree::tree: invalid range");
+        }
+    }
+
+    T query_nodes(std::size_t l, std::size_t r) const {
+        T left_value = Monoid::identity();
+        T right_value = Monoid::identity();
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) {
+                left_value = Monoid::combine(left_value, nodes_[l++]);
+            }
+            if (r & 1) {
+                right_value = Monoid::combine(nodes_[--r], right_value);
+            }
+        }
+        return Monoid::combine(left_value, right_value);
+    }
+
+    void apply_node(std::size_t node, std::size_t len, const tag_type &tag) {
+        nodes_[node] = LazyTag::apply(nodes_[node], tag, len);
+        if (node < capacity_) {
+            tags_[node] = LazyTag::compose(tags_[node], tag);
+        }
+    }
+
+    void push(std::size_t node, std::size_t len) {
+        if (!(tags_[node] == LazyTag::none())) {
+            apply_node(2 * node, len / 2, tags_[node]);
+            apply_node(2 * node + 1, len / 2, tags_[node]);
+            tags_[node] = LazyTag::none();
+        }
+    }
+
+    void pull(std::size_t node) {
+        nodes_[node] = Monoid::combine(nodes_[2 * node], nodes_[2 * node + 1]);
+    }
+
+    void push_boundaries(std::size_t l, std::size_t r) {
+        for (int h = height_; h >= 1; h--) {
+            if (((l >> h) << h) != l) {
+                push(l >> h, std::size_t{1} << h);
+            }
+            if (((r >> h) << h) != r) {
+                push((r - 1) >> h, std::size_t{1} << h);
+            }
+        }
+    }
+
+    std::unique_ptr<T[]> nodes_;
+    std::unique_ptr<tag_type[]> tags_;
+    std::size_t size_;
+    std::size_t capacity_;
+    int height_;
+};
+
+} // namespace segtree
+
+#endif
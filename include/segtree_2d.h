@@ -0,0 +1,27 @@
+#ifndef SEGTREE_2D_H
+#define SEGTREE_2D_H
+
+#include "segment_tree.h"
+
+typedef struct segtree_2d {
+    int *tree;
+    int rows;
+    int cols;
+    int row_capacity;
+    int col_capacity;
+    int stride;
+    segtree_operation_t op_type;
+
+    int (*combine)(int a, int b);
+
+    int identity;
+    segtree_stats_t stats;
+} segtree_2d_t;
+
+segtree_2d_t* segtree_2d_create(int *grid, int rows, int cols, segtree_operation_t op);
+void segtree_2d_destroy(segtree_2d_t *st);
+
+segtree_error_t segtree_2d_query(segtree_2d_t *st, int row1, int col1, int row2, int col2, int *result);
+segtree_error_t segtree_2d_update_point(segtree_2d_t *st, int row, int col, int value);
+
+#endif
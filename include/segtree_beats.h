@@ -0,0 +1,39 @@
+#ifndef SEGTREE_BEATS_H
+#define SEGTREE_BEATS_H
+
+#include "segment_tree.h"
+
+/* Outside the int range, so every int value can still be a real second extreme. */
+#define SEGTREE_BEATS_NO_MAX2 ((long long)SEGTREE_NEG_INF - 1)
+#define SEGTREE_BEATS_NO_MIN2 ((long long)SEGTREE_INF + 1)
+
+typedef struct {
+    long long sum;
+    int max1;               /* largest value */
+    long long max2;         /* strictly second largest, SEGTREE_BEATS_NO_MAX2 if none */
+    int max_count;
+    int min1;
+    long long min2;         /* strictly second smallest, SEGTREE_BEATS_NO_MIN2 if none */
+    int min_count;
+    int add;                /* pending add for the children */
+} segtree_beats_node_t;
+
+typedef struct segtree_beats {
+    segtree_beats_node_t *nodes;
+    int size;
+    int tree_size;
+    segtree_stats_t stats;
+} segtree_beats_t;
+
+segtree_beats_t* segtree_beats_create(int *arr, int n);
+void segtree_beats_destroy(segtree_beats_t *bt);
+
+segtree_error_t segtree_beats_chmin(segtree_beats_t *bt, int left, int right, int value);
+segtree_error_t segtree_beats_chmax(segtree_beats_t *bt, int left, int right, int value);
+segtree_error_t segtree_beats_add(segtree_beats_t *bt, int left, int right, int value);
+
+segtree_error_t segtree_beats_query_sum(segtree_beats_t *bt, int left, int right, long long *result);
+segtree_error_t segtree_beats_query_min(segtree_beats_t *bt, int left, int right, int *result);
+segtree_error_t segtree_beats_query_max(segtree_beats_t *bt, int left, int right, int *result);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SEGTREE_COVER_H
+#define SEGTREE_COVER_H
+
+#include "segment_tree.h"
+
+/*
+ * Interval coverage over half-open coordinate ranges [begin, end).
+ * Elementary segment i spans [coords[i], coords[i + 1]); without
+ * compression coords is NULL and segment i is the unit cell [i, i + 1).
+ */
+typedef struct segtree_cover {
+    int *count;             /* intervals covering the whole node, not pushed down */
+    long long *covered;     /* covered length inside the node */
+    int *coords;
+    int segments;
+    int tree_size;
+    segtree_stats_t stats;
+} segtree_cover_t;
+
+segtree_cover_t* segtree_cover_create(int n);
+segtree_cover_t* segtree_cover_create_compressed(const int *coords, int count);
+void segtree_cover_destroy(segtree_cover_t *ct);
+
+segtree_error_t segtree_cover_add(segtree_cover_t *ct, int begin, int end);
+segtree_error_t segtree_cover_remove(segtree_cover_t *ct, int begin, int end);
+
+long long segtree_cover_total(const segtree_cover_t *ct);
+segtree_error_t segtree_cover_query(segtree_cover_t *ct, int begin, int end, long long *length);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef SEGTREE_DISK_H
+#define SEGTREE_DISK_H
+
+#include "segment_tree.h"
+
+#define SEGTREE_DISK_PAGE_SIZE 4096
+#define SEGTREE_DISK_PAGE_NODES (SEGTREE_DISK_PAGE_SIZE / 8)
+#define SEGTREE_DISK_BAND_LEVELS 8
+#define SEGTREE_DISK_MAX_BANDS 8
+#define SEGTREE_DISK_MAX_SIZE (1LL << 40)
+
+typedef struct {
+    unsigned long long page_reads;
+    unsigned long long page_writes;
+    unsigned long long bytes_read;
+    unsigned long long bytes_written;
+    unsigned long long cache_hits;
+    unsigned long long cache_misses;
+    unsigned long long evictions;
+} segtree_disk_io_t;
+
+struct segtree_disk_cache;
+
+/*
+ * Supplies the next leaves in index order: fills up to n values into buf
+ * and returns how many were written, or a negative value on error. The
+ * builder asks for at most one leaf page at a time, so the input never
+ * has to fit in memory.
+ */
+typedef int (*segtree_disk_reader_t)(void *ctx, int *buf, size_t n);
+
+/*
+ * The top resident_levels of the heap live in memory. Everything below is
+ * split into bands of SEGTREE_DISK_BAND_LEVELS levels (the top band may be
+ * shorter); one page holds the two sibling subtrees under a node, so a
+ * root-to-leaf path touches one page per band.
+ */
+typedef struct segtree_disk {
+    int fd;
+    long long size;
+    long long capacity;
+    int depth;
+    int resident_levels;
+    int band_count;
+    int band_top[SEGTREE_DISK_MAX_BANDS + 1];      /* first depth of each band, then depth + 1 */
+    long long band_offset[SEGTREE_DISK_MAX_BANDS];
+    long long page_count;
+    long long *resident;
+
+    segtree_operation_t op_type;
+    long long identity;
+
+    struct segtree_disk_cache *cache;
+    segtree_disk_io_t io;
+    segtree_stats_t stats;
+} segtree_disk_t;
+
+segtree_disk_t* segtree_disk_create(const char *path, segtree_disk_reader_t next, void *ctx, long long n,
+                                    segtree_operation_t op, int resident_levels, int cache_pages);
+segtree_disk_t* segtree_disk_open(const char *path, int cache_pages);
+void segtree_disk_destroy(segtree_disk_t *dt);
+
+segtree_error_t segtree_disk_query(segtree_disk_t *dt, long long left, long long right, long long *result);
+segtree_error_t segtree_disk_update_point(segtree_disk_t *dt, long long index, int value);
+segtree_error_t segtree_disk_flush(segtree_disk_t *dt);
+
+segtree_disk_io_t segtree_disk_get_io(segtree_disk_t *dt);
+void segtree_disk_reset_io(segtree_disk_t *dt);
+
+#endif
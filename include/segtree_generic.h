@@ -0,0 +1,131 @@
+#ifndef SEGTREE_GENERIC_H
+#define SEGTREE_GENERIC_H
+
+#include <stddef.h>
+#include "segment_tree.h"
+
+/* out never aliases a or b; a is always the left operand. */
+typedef void (*segtree_generic_combine_t)(void *ctx, const void *a, const void *b, void *out);
+
+typedef struct segtree_generic {
+    unsigned char *tree;            /* node i at tree + i * stride */
+    unsigned char *block;           /* unaligned allocation backing tree */
+    size_t elem_size;
+    size_t alignment;
+    size_t stride;
+    int size;
+    int capacity;
+
+    segtree_generic_combine_t combine;
+    void *ctx;
+
+    unsigned char *identity;        /* stride bytes */
+    unsigned char *scratch;         /* three stride-sized query temporaries */
+
+    segtree_stats_t stats;
+} segtree_generic_t;
+
+segtree_generic_t* segtree_generic_create(const void *arr, int n, size_t elem_size, size_t alignment,
+                                          segtree_generic_combine_t combine, void *ctx,
+                                          const void *identity);
+void segtree_generic_destroy(segtree_generic_t *st);
+
+segtree_error_t segtree_generic_query(segtree_generic_t *st, int left, int right, void *result);
+segtree_error_t segtree_generic_update_point(segtree_generic_t *st, int index, const void *value);
+segtree_error_t segtree_generic_get(segtree_generic_t *st, int index, void *value);
+
+/*
+ * Typed instantiation with the combine inlined into the loops:
+ *
+ *     static inline pair_t pair_add(void *ctx, pair_t a, pair_t b) { ... }
+ *     SEGTREE_DEFINE_TYPED(pairtree, pair_t, pair_add)
+ *
+ * defines pairtree_t and pairtree_create/destroy/query/update_point.
+ */
+#define SEGTREE_DEFINE_TYPED(name, T, COMBINE)                                              \
+    typedef struct name {                                                                   \
+        T *tree;                                                                            \
+        int size;                                                                           \
+        int capacity;                                                                       \
+        T identity;                                                                         \
+        void *ctx;                                                                          \
+        segtree_stats_t stats;                                                              \
+    } name##_t;                                                                             \
+                                                                                            \
+    static inline name##_t* name##_create(const T *arr, int n, T identity, void *ctx) {     \
+        if (arr == NULL || n <= 0 || n > SEGTREE_MAX_SIZE) {                                \
+            return NULL;                                                                    \
+        }                                                                                   \
+        name##_t *st = (name##_t*)malloc(sizeof(name##_t));                                 \
+        if (st == NULL) {                                                                   \
+            return NULL;                                                                    \
+        }                                                                                   \
+        st->size = n;                                                                       \
+        st->capacity = 1;                                                                   \
+        while (st->capacity < n) {                                                          \
+            st->capacity *= 2;                                                              \
+        }                                                                                   \
+        st->tree = (T*)malloc(2 * (size_t)st->capacity * sizeof(T));                        \
+        if (st->tree == NULL) {                                                             \
+            free(st);                                                                       \
+            return NULL;                                                                    \
+        }                                                                                   \
+        st->identity = identity;                                                            \
+        st->ctx = ctx;                                                                      \
+        for (int i = 0; i < st->capacity; i++) {                                            \
+            st->tree[st->capacity + i] = (i < n) ? arr[i] : identity;                       \
+        }                                                                                   \
+        for (int node = st->capacity - 1; node >= 1; node--) {                              \
+            st->tree[node] = COMBINE(ctx, st->tree[2 * node], st->tree[2 * node + 1]);      \
+        }                                                                                   \
+        memset(&st->stats, 0, sizeof(segtree_stats_t));                                    \
+        return st;                                                                          \
+    }                                                                                       \
+                                                                                            \
+    static inline void name##_destroy(name##_t *st) {                                       \
+        if (st == NULL) {                                                                   \
+            return;                                                                         \
+        }                                                                                   \
+        free(st->tree);                                                                     \
+        free(st);                                                                           \
+    }                                                                                       \
+                                                                                            \
+    static inline segtree_error_t name##_query(name##_t *st, int left, int right, T *result) { \
+        if (st == NULL || result == NULL) {                                                 \
+            return SEGTREE_ERROR_NULL_POINTER;                                              \
+        }                                                                                   \
+        if (left < 0 || right >= st->size || left > right) {                                \
+            return SEGTREE_ERROR_INVALID_RANGE;                                             \
+        }                                                                                   \
+        T left_value = st->identity;                                                        \
+        T right_value = st->identity;                                                       \
+        for (int l = left + st->capacity, r = right + st->capacity + 1; l < r; l /= 2, r /= 2) { \
+            if (l & 1) {                                                                    \
+                left_value = COMBINE(st->ctx, left_value, st->tree[l++]);                   \
+            }                                                                               \
+            if (r & 1) {                                                                    \
+                right_value = COMBINE(st->ctx, st->tree[--r], right_value);                 \
+            }                                                                               \
+        }                                                                                   \
+        *result = COMBINE(st->ctx, left_value, right_value);                                \
+        st->stats.query_count++;                                                            \
+        return SEGTREE_OK;                                                                  \
+    }                                                                                       \
+                                                                                            \
+    static inline segtree_error_t name##_update_point(name##_t *st, int index, T value) {   \
+        if (st == NULL) {                                                                   \
+            return SEGTREE_ERROR_NULL_POINTER;                                              \
+        }                                                                                   \
+        if (index < 0 || index >= st->size) {                                               \
+            return SEGTREE_ERROR_INVALID_RANGE;                                             \
+        }                                                                                   \
+        int node = index + st->capacity;                                                    \
+        st->tree[node] = value;                                                             \
+        for (node /= 2; node >= 1; node /= 2) {                                             \
+            st->tree[node] = COMBINE(st->ctx, st->tree[2 * node], st->tree[2 * node + 1]);  \
+        }                                                                                   \
+        st->stats.update_count++;                                                           \
+        return SEGTREE_OK;                                                                  \
+    }
+
+#endif
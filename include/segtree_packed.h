@@ -0,0 +1,42 @@
+#ifndef SEGTREE_PACKED_H
+#define SEGTREE_PACKED_H
+
+#include <stdint.h>
+#include "segment_tree.h"
+
+#define SEGTREE_PACKED_BLOCK 64
+
+typedef struct {
+    int base;               /* smallest value in the block */
+    int width;              /* bits per delta, 0..32 */
+    uint32_t offset;        /* start of the block's deltas in the arena */
+    uint32_t room;          /* bytes reserved there, at least the packed size */
+} segtree_packed_block_t;
+
+typedef struct segtree_packed {
+    segtree_packed_block_t *blocks;
+    int block_count;
+    int size;
+
+    uint8_t *arena;         /* every block's deltas, bit-packed back to back */
+    size_t arena_used;
+    size_t arena_capacity;
+
+    int *tree;              /* full-width aggregates, one leaf per block */
+    int capacity;
+    segtree_operation_t op_type;
+    int identity;
+
+    segtree_stats_t stats;
+} segtree_packed_t;
+
+segtree_packed_t* segtree_packed_create(int *arr, int n, segtree_operation_t op);
+void segtree_packed_destroy(segtree_packed_t *pt);
+
+segtree_error_t segtree_packed_query(segtree_packed_t *pt, int left, int right, int *result);
+segtree_error_t segtree_packed_get(segtree_packed_t *pt, int index, int *value);
+segtree_error_t segtree_packed_update_point(segtree_packed_t *pt, int index, int value);
+
+size_t segtree_packed_memory_usage(segtree_packed_t *pt);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef SEGTREE_WAVELET_H
+#define SEGTREE_WAVELET_H
+
+#include <stdint.h>
+#include "segment_tree.h"
+
+typedef struct segtree_wavelet {
+    int size;
+    int levels;
+    int words_per_level;
+
+    int *values;            /* sorted distinct values, indexed by compressed code */
+    int value_count;
+
+    uint64_t *bits;         /* levels * words_per_level bit words */
+    unsigned int *ranks;    /* ones before each word */
+    int *zeros;             /* zero count per level */
+
+    segtree_stats_t stats;
+} segtree_wavelet_t;
+
+segtree_wavelet_t* segtree_wavelet_create(int *arr, int n);
+void segtree_wavelet_destroy(segtree_wavelet_t *wt);
+
+segtree_error_t segtree_wavelet_kth_smallest(segtree_wavelet_t *wt, int left, int right, int k, int *result);
+segtree_error_t segtree_wavelet_count_leq(segtree_wavelet_t *wt, int left, int right, int x, int *count);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef SEGTREE_WINDOW_H
+#define SEGTREE_WINDOW_H
+
+#include "segment_tree.h"
+
+typedef struct segtree_window {
+    int *tree;
+    int window;             /* number of most recent values kept */
+    int capacity;
+    int head;               /* ring slot the next push writes */
+    int count;              /* values currently in the window */
+    segtree_operation_t op_type;
+    int identity;
+    segtree_stats_t stats;
+} segtree_window_t;
+
+segtree_window_t* segtree_window_create(int window, segtree_operation_t op);
+void segtree_window_destroy(segtree_window_t *wt);
+
+segtree_error_t segtree_window_push(segtree_window_t *wt, int value);
+segtree_error_t segtree_window_query(segtree_window_t *wt, int k, int *result);
+
+#endif
@@ -0,0 +1,184 @@
+#include "../include/segment_tree.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SEGTREE_BUILD_X86 1
+#endif
+
+typedef void (*level_reducer_t)(const int *children, int *parents, int count);
+
+/* parents[i] = children[2i] op children[2i+1] for i in [0, count). */
+static void reduce_sum_scalar(const int *children, int *parents, int count) {
+    for (int i = 0; i < count; i++) {
+        parents[i] = (int)((unsigned int)children[2 * i] + (unsigned int)children[2 * i + 1]);
+    }
+}
+
+static void reduce_min_scalar(const int *children, int *parents, int count) {
+    for (int i = 0; i < count; i++) {
+        int a = children[2 * i];
+        int b = children[2 * i + 1];
+        parents[i] = a < b ? a : b;
+    }
+}
+
+static void reduce_max_scalar(const int *children, int *parents, int count) {
+    for (int i = 0; i < count; i++) {
+        int a = children[2 * i];
+        int b = children[2 * i + 1];
+        parents[i] = a > b ? a : b;
+    }
+}
+
+#ifdef SEGTREE_BUILD_X86
+/* SSE2: split eight children into even and odd lanes, then combine four parents at once. */
+#define SSE2_SPLIT(children, i, evens, odds)                                             \
+    do {                                                                                  \
+        __m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)((children) + 2 * (i))));     \
+        __m128 hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)((children) + 2 * (i) + 4))); \
+        evens = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));        \
+        odds = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));         \
+    } while (0)
+
+static void reduce_sum_sse2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i evens, odds;
+        SSE2_SPLIT(children, i, evens, odds);
+        _mm_storeu_si128((__m128i*)(parents + i), _mm_add_epi32(evens, odds));
+    }
+    reduce_sum_scalar(children + 2 * i, parents + i, count - i);
+}
+
+static void reduce_min_sse2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i evens, odds;
+        SSE2_SPLIT(children, i, evens, odds);
+        __m128i odd_smaller = _mm_cmpgt_epi32(evens, odds);
+        __m128i result = _mm_or_si128(_mm_and_si128(odd_smaller, odds), _mm_andnot_si128(odd_smaller, evens));
+        _mm_storeu_si128((__m128i*)(parents + i), result);
+    }
+    reduce_min_scalar(children + 2 * i, parents + i, count - i);
+}
+
+static void reduce_max_sse2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i evens, odds;
+        SSE2_SPLIT(children, i, evens, odds);
+        __m128i even_larger = _mm_cmpgt_epi32(evens, odds);
+        __m128i result = _mm_or_si128(_mm_and_si128(even_larger, evens), _mm_andnot_si128(even_larger, odds));
+        _mm_storeu_si128((__m128i*)(parents + i), result);
+    }
+    reduce_max_scalar(children + 2 * i, parents + i, count - i);
+}
+
+/* AVX2: same split on sixteen children; the 128-bit lanes come out as 0,2,1,3. */
+#define AVX2_SPLIT(children, i, evens, odds)                                                  \
+    do {                                                                                       \
+        __m256 lo = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)((children) + 2 * (i))));     \
+        __m256 hi = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)((children) + 2 * (i) + 8))); \
+        evens = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));       \
+        odds = _mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));        \
+    } while (0)
+
+__attribute__((target("avx2")))
+static void reduce_sum_avx2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i evens, odds;
+        AVX2_SPLIT(children, i, evens, odds);
+        __m256i result = _mm256_permute4x64_epi64(_mm256_add_epi32(evens, odds), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(parents + i), result);
+    }
+    reduce_sum_scalar(children + 2 * i, parents + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void reduce_min_avx2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i evens, odds;
+        AVX2_SPLIT(children, i, evens, odds);
+        __m256i result = _mm256_permute4x64_epi64(_mm256_min_epi32(evens, odds), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(parents + i), result);
+    }
+    reduce_min_scalar(children + 2 * i, parents + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void reduce_max_avx2(const int *children, int *parents, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i evens, odds;
+        AVX2_SPLIT(children, i, evens, odds);
+        __m256i result = _mm256_permute4x64_epi64(_mm256_max_epi32(evens, odds), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(parents + i), result);
+    }
+    reduce_max_scalar(children + 2 * i, parents + i, count - i);
+}
+
+static int cpu_has_avx2(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return cached;
+}
+#endif
+
+static level_reducer_t select_reducer(segtree_operation_t op) {
+#ifdef SEGTREE_BUILD_X86
+    bool avx2 = cpu_has_avx2();
+    switch (op) {
+        case SEGTREE_SUM:
+            return avx2 ? reduce_sum_avx2 : reduce_sum_sse2;
+        case SEGTREE_MIN:
+            return avx2 ? reduce_min_avx2 : reduce_min_sse2;
+        case SEGTREE_MAX:
+            return avx2 ? reduce_max_avx2 : reduce_max_sse2;
+        default:
+            return NULL;
+    }
+#else
+    switch (op) {
+        case SEGTREE_SUM:
+            return reduce_sum_scalar;
+        case SEGTREE_MIN:
+            return reduce_min_scalar;
+        case SEGTREE_MAX:
+            return reduce_max_scalar;
+        default:
+            return NULL;
+    }
+#endif
+}
+
+void segtree_build_internal(segment_tree_t *st) {
+    level_reducer_t reducer = select_reducer(st->op_type);
+
+    /* Level [width, 2 * width) is reduced from the contiguous level below it. */
+    for (int width = st->capacity / 2; width >= 1; width /= 2) {
+        if (reducer != NULL) {
+            reducer(st->tree + 2 * width, st->tree + width, width);
+        } else {
+            for (int node = width; node < 2 * width; node++) {
+                st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
+            }
+        }
+    }
+}
+
+void segtree_build_bottom_up(segment_tree_t *st, int *arr, int n) {
+    int *leaves = st->tree + st->capacity;
+
+    memcpy(leaves, arr, (size_t)n * sizeof(int));
+    for (int i = n; i < st->capacity; i++) {
+        leaves[i] = st->identity;
+    }
+    st->tree[0] = st->identity;
+
+    segtree_build_internal(st);
+}
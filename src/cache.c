@@ -0,0 +1,124 @@
+#include "../include/segment_tree.h"
+
+static int cache_block_shift(int capacity) {
+    int shift = 0;
+    while ((capacity >> shift) > SEGTREE_CACHE_EPOCH_BLOCKS) {
+        shift++;
+    }
+    return shift;
+}
+
+static inline unsigned int cache_slot(const segtree_cache_t *cache, int left, int right) {
+    unsigned int h = (unsigned int)left * 0x9e3779b1u ^ (unsigned int)right * 0x85ebca77u;
+    h ^= h >> 15;
+    return h & cache->mask;
+}
+
+static void cache_clear(segtree_cache_t *cache) {
+    for (int i = 0; i <= cache->mask; i++) {
+        cache->entries[i].left = -1;
+        cache->entries[i].right = -1;
+        cache->entries[i].stamp = 0;
+    }
+    memset(cache->block_epoch, 0, sizeof(cache->block_epoch));
+    cache->clock = 1;
+}
+
+segtree_error_t segtree_cache_enable(segment_tree_t *st, int slots) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (slots <= 0 || slots > SEGTREE_MAX_SIZE) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    int capacity = 1;
+    while (capacity < slots) {
+        capacity *= 2;
+    }
+
+    segtree_cache_t *cache = (segtree_cache_t*)malloc(sizeof(segtree_cache_t));
+    if (cache == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    cache->entries = (segtree_cache_entry_t*)malloc(capacity * sizeof(segtree_cache_entry_t));
+    if (cache->entries == NULL) {
+        free(cache);
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    cache->mask = capacity - 1;
+    cache->block_shift = cache_block_shift(st->capacity);
+    cache_clear(cache);
+
+    segtree_cache_disable(st);
+    st->cache = cache;
+
+    return SEGTREE_OK;
+}
+
+void segtree_cache_disable(segment_tree_t *st) {
+    if (st == NULL || st->cache == NULL) {
+        return;
+    }
+
+    free(st->cache->entries);
+    free(st->cache);
+    st->cache = NULL;
+}
+
+bool segtree_cache_lookup(segment_tree_t *st, int left, int right, int *result) {
+    segtree_cache_t *cache = st->cache;
+    const segtree_cache_entry_t *entry = &cache->entries[cache_slot(cache, left, right)];
+
+    if (entry->left == left && entry->right == right) {
+        bool fresh = true;
+        for (int b = left >> cache->block_shift; b <= (right >> cache->block_shift); b++) {
+            if (cache->block_epoch[b] > entry->stamp) {
+                fresh = false;
+                break;
+            }
+        }
+
+        if (fresh) {
+            *result = entry->value;
+            st->stats.cache_hits++;
+            return true;
+        }
+    }
+
+    st->stats.cache_misses++;
+    return false;
+}
+
+void segtree_cache_store(segment_tree_t *st, int left, int right, int value) {
+    segtree_cache_t *cache = st->cache;
+    segtree_cache_entry_t *entry = &cache->entries[cache_slot(cache, left, right)];
+
+    entry->left = left;
+    entry->right = right;
+    entry->value = value;
+    entry->stamp = cache->clock;
+}
+
+void segtree_cache_invalidate(segment_tree_t *st, int left, int right) {
+    segtree_cache_t *cache = st->cache;
+
+    if (++cache->clock == 0) {
+        cache_clear(cache);
+        return;
+    }
+
+    for (int b = left >> cache->block_shift; b <= (right >> cache->block_shift); b++) {
+        cache->block_epoch[b] = cache->clock;
+    }
+}
+
+void segtree_cache_invalidate_all(segment_tree_t *st) {
+    segtree_cache_t *cache = st->cache;
+
+    cache->block_shift = cache_block_shift(st->capacity);
+    cache_clear(cache);
+}
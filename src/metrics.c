@@ -0,0 +1,375 @@
+#define _XOPEN_SOURCE 700
+
+#include "../include/segment_tree.h"
+#include <pthread.h>
+
+/* Each thread writes only its own slot; relaxed atomic loads and stores
+ * let a collector read live slots without a lock on the hot path. */
+#if defined(__GNUC__)
+#define METRIC_LOAD(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define METRIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define METRIC_LOAD(p) (*(p))
+#define METRIC_STORE(p, v) (*(p) = (v))
+#endif
+
+typedef struct metrics_slot {
+    segtree_metrics_t metrics;
+    struct metrics_slot *prev;
+    struct metrics_slot *next;
+} metrics_slot_t;
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t registry_once = PTHREAD_ONCE_INIT;
+static pthread_key_t registry_key;
+static metrics_slot_t *registry_head = NULL;
+static segtree_metrics_t retired;
+static __thread metrics_slot_t *local_slot = NULL;
+
+static const char *op_names[SEGTREE_PERF_OP_COUNT] = {
+    "query", "update_point", "update_range", "build"
+};
+
+unsigned long long segtree_clock_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ULL + (unsigned long long)now.tv_nsec;
+}
+
+static int bucket_index(unsigned long long ns) {
+    if (ns < (1ULL << SEGTREE_HIST_SUB_BITS)) {
+        return (int)ns;
+    }
+
+    int msb = 63 - __builtin_clzll(ns);
+    if (msb >= SEGTREE_HIST_MAX_BITS) {
+        return SEGTREE_HIST_BUCKETS - 1;
+    }
+
+    int shift = msb - SEGTREE_HIST_SUB_BITS;
+    return (shift << SEGTREE_HIST_SUB_BITS) + (int)(ns >> shift);
+}
+
+static unsigned long long bucket_lower(int index) {
+    if (index < (2 << SEGTREE_HIST_SUB_BITS)) {
+        return (unsigned long long)index;
+    }
+
+    int shift = (index >> SEGTREE_HIST_SUB_BITS) - 1;
+    return (unsigned long long)(index - (shift << SEGTREE_HIST_SUB_BITS)) << shift;
+}
+
+static unsigned long long bucket_upper(int index) {
+    return (index + 1 < SEGTREE_HIST_BUCKETS) ? bucket_lower(index + 1) : 1ULL << SEGTREE_HIST_MAX_BITS;
+}
+
+void segtree_histogram_record(segtree_histogram_t *hist, unsigned long long ns) {
+    segtree_histogram_record_batch(hist, ns, 1);
+}
+
+/* A batch of items that took total_ns together counts as items samples of
+ * total_ns / items each; the sum keeps the exact total. */
+void segtree_histogram_record_batch(segtree_histogram_t *hist, unsigned long long total_ns,
+                                    unsigned long long items) {
+    if (hist == NULL || items == 0) {
+        return;
+    }
+
+    unsigned long long ns = total_ns / items;
+    unsigned long long count = METRIC_LOAD(&hist->count);
+    if (count == 0 || ns < METRIC_LOAD(&hist->min_ns)) {
+        METRIC_STORE(&hist->min_ns, ns);
+    }
+    if (ns > METRIC_LOAD(&hist->max_ns)) {
+        METRIC_STORE(&hist->max_ns, ns);
+    }
+
+    unsigned long long *bucket = &hist->buckets[bucket_index(ns)];
+    METRIC_STORE(bucket, METRIC_LOAD(bucket) + items);
+    METRIC_STORE(&hist->sum_ns, METRIC_LOAD(&hist->sum_ns) + total_ns);
+    METRIC_STORE(&hist->count, count + items);
+}
+
+void segtree_histogram_merge(segtree_histogram_t *dst, const segtree_histogram_t *src) {
+    if (dst == NULL || src == NULL) {
+        return;
+    }
+
+    unsigned long long count = METRIC_LOAD(&src->count);
+    if (count == 0) {
+        return;
+    }
+
+    unsigned long long min_ns = METRIC_LOAD(&src->min_ns);
+    unsigned long long max_ns = METRIC_LOAD(&src->max_ns);
+    if (dst->count == 0 || min_ns < dst->min_ns) {
+        dst->min_ns = min_ns;
+    }
+    if (max_ns > dst->max_ns) {
+        dst->max_ns = max_ns;
+    }
+
+    for (int i = 0; i < SEGTREE_HIST_BUCKETS; i++) {
+        dst->buckets[i] += METRIC_LOAD(&src->buckets[i]);
+    }
+    dst->sum_ns += METRIC_LOAD(&src->sum_ns);
+    dst->count += count;
+}
+
+/* Highest value equivalent to the bucket holding the rank, capped at max. */
+unsigned long long segtree_histogram_percentile(const segtree_histogram_t *hist, double percentile) {
+    if (hist == NULL || hist->count == 0) {
+        return 0;
+    }
+
+    if (percentile <= 0.0) {
+        return hist->min_ns;
+    }
+
+    unsigned long long rank = (unsigned long long)(percentile / 100.0 * (double)hist->count + 0.999999);
+    if (rank > hist->count) {
+        rank = hist->count;
+    }
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < SEGTREE_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            unsigned long long value = bucket_upper(i) - 1;
+            return (value < hist->max_ns) ? value : hist->max_ns;
+        }
+    }
+
+    return hist->max_ns;
+}
+
+static void retire_slot(void *arg) {
+    metrics_slot_t *slot = (metrics_slot_t*)arg;
+
+    pthread_mutex_lock(&registry_lock);
+    segtree_metrics_merge(&retired, &slot->metrics);
+    if (slot->prev != NULL) {
+        slot->prev->next = slot->next;
+    } else {
+        registry_head = slot->next;
+    }
+    if (slot->next != NULL) {
+        slot->next->prev = slot->prev;
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    free(slot);
+}
+
+static void registry_init(void) {
+    pthread_key_create(&registry_key, retire_slot);
+}
+
+static metrics_slot_t* attach_slot(void) {
+    pthread_once(&registry_once, registry_init);
+
+    metrics_slot_t *slot = (metrics_slot_t*)calloc(1, sizeof(metrics_slot_t));
+    if (slot == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    slot->next = registry_head;
+    if (registry_head != NULL) {
+        registry_head->prev = slot;
+    }
+    registry_head = slot;
+    pthread_mutex_unlock(&registry_lock);
+
+    /* The key's destructor folds the slot into the retired totals at thread exit. */
+    pthread_setspecific(registry_key, slot);
+    local_slot = slot;
+    return slot;
+}
+
+void segtree_metrics_record(segtree_perf_op_t op, unsigned long long ns) {
+    segtree_metrics_record_batch(op, ns, 1);
+}
+
+void segtree_metrics_record_batch(segtree_perf_op_t op, unsigned long long total_ns, unsigned long long items) {
+    if (op < 0 || op >= SEGTREE_PERF_OP_COUNT || items == 0) {
+        return;
+    }
+
+    metrics_slot_t *slot = local_slot;
+    if (slot == NULL) {
+        slot = attach_slot();
+        if (slot == NULL) {
+            return;
+        }
+    }
+
+    segtree_histogram_record_batch(&slot->metrics.ops[op], total_ns, items);
+}
+
+void segtree_metrics_local(segtree_metrics_t *out) {
+    if (out == NULL) {
+        return;
+    }
+
+    memset(out, 0, sizeof(segtree_metrics_t));
+    if (local_slot != NULL) {
+        segtree_metrics_merge(out, &local_slot->metrics);
+    }
+}
+
+void segtree_metrics_reset_local(void) {
+    if (local_slot == NULL) {
+        return;
+    }
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        segtree_histogram_t *hist = &local_slot->metrics.ops[op];
+        METRIC_STORE(&hist->count, 0ULL);
+        METRIC_STORE(&hist->sum_ns, 0ULL);
+        METRIC_STORE(&hist->min_ns, 0ULL);
+        METRIC_STORE(&hist->max_ns, 0ULL);
+        for (int i = 0; i < SEGTREE_HIST_BUCKETS; i++) {
+            METRIC_STORE(&hist->buckets[i], 0ULL);
+        }
+    }
+}
+
+void segtree_metrics_merge(segtree_metrics_t *dst, const segtree_metrics_t *src) {
+    if (dst == NULL || src == NULL) {
+        return;
+    }
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        segtree_histogram_merge(&dst->ops[op], &src->ops[op]);
+    }
+}
+
+void segtree_metrics_collect(segtree_metrics_t *out) {
+    if (out == NULL) {
+        return;
+    }
+
+    memset(out, 0, sizeof(segtree_metrics_t));
+
+    pthread_mutex_lock(&registry_lock);
+    segtree_metrics_merge(out, &retired);
+    for (metrics_slot_t *slot = registry_head; slot != NULL; slot = slot->next) {
+        segtree_metrics_merge(out, &slot->metrics);
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static const double export_quantiles[] = {50.0, 90.0, 99.0, 99.9};
+#define EXPORT_QUANTILE_COUNT 4
+
+static bool export_prometheus(int fd, const segtree_metrics_t *metrics) {
+    if (dprintf(fd, "# HELP segtree_operation_latency_seconds Latency of single segment tree operations.\n"
+                    "# TYPE segtree_operation_latency_seconds histogram\n") < 0) {
+        return false;
+    }
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        const segtree_histogram_t *hist = &metrics->ops[op];
+        unsigned long long cumulative = 0;
+        int bucket = 0;
+
+        /* Octave boundaries are bucket boundaries, so these counts are exact. */
+        for (int bits = SEGTREE_HIST_SUB_BITS; bits <= SEGTREE_HIST_MAX_BITS; bits++) {
+            unsigned long long bound = 1ULL << bits;
+            while (bucket < SEGTREE_HIST_BUCKETS && bucket_upper(bucket) <= bound) {
+                cumulative += hist->buckets[bucket++];
+            }
+            if (dprintf(fd, "segtree_operation_latency_seconds_bucket{op=\"%s\",le=\"%.9g\"} %llu\n",
+                        op_names[op], (double)bound / 1e9, cumulative) < 0) {
+                return false;
+            }
+        }
+
+        if (dprintf(fd, "segtree_operation_latency_seconds_bucket{op=\"%s\",le=\"+Inf\"} %llu\n"
+                        "segtree_operation_latency_seconds_sum{op=\"%s\"} %.9f\n"
+                        "segtree_operation_latency_seconds_count{op=\"%s\"} %llu\n",
+                    op_names[op], hist->count, op_names[op], (double)hist->sum_ns / 1e9,
+                    op_names[op], hist->count) < 0) {
+            return false;
+        }
+    }
+
+    if (dprintf(fd, "# HELP segtree_operation_latency_quantile_seconds Latency quantiles from the histogram.\n"
+                    "# TYPE segtree_operation_latency_quantile_seconds gauge\n") < 0) {
+        return false;
+    }
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        for (int q = 0; q < EXPORT_QUANTILE_COUNT; q++) {
+            unsigned long long value = segtree_histogram_percentile(&metrics->ops[op], export_quantiles[q]);
+            if (dprintf(fd, "segtree_operation_latency_quantile_seconds{op=\"%s\",quantile=\"%g\"} %.9g\n",
+                        op_names[op], export_quantiles[q] / 100.0, (double)value / 1e9) < 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool export_json(int fd, const segtree_metrics_t *metrics) {
+    if (dprintf(fd, "{") < 0) {
+        return false;
+    }
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        const segtree_histogram_t *hist = &metrics->ops[op];
+
+        if (dprintf(fd, "%s\"%s\":{\"count\":%llu,\"sum_ns\":%llu,\"min_ns\":%llu,\"max_ns\":%llu,"
+                        "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"buckets\":[",
+                    op == 0 ? "" : ",", op_names[op], hist->count, hist->sum_ns, hist->min_ns, hist->max_ns,
+                    segtree_histogram_percentile(hist, 50.0), segtree_histogram_percentile(hist, 90.0),
+                    segtree_histogram_percentile(hist, 99.0), segtree_histogram_percentile(hist, 99.9)) < 0) {
+            return false;
+        }
+
+        /* Only non-empty buckets, as [lower_ns, upper_ns, count]. */
+        bool first = true;
+        for (int i = 0; i < SEGTREE_HIST_BUCKETS; i++) {
+            if (hist->buckets[i] == 0) {
+                continue;
+            }
+            if (dprintf(fd, "%s[%llu,%llu,%llu]", first ? "" : ",",
+                        bucket_lower(i), bucket_upper(i), hist->buckets[i]) < 0) {
+                return false;
+            }
+            first = false;
+        }
+
+        if (dprintf(fd, "]}") < 0) {
+            return false;
+        }
+    }
+
+    return dprintf(fd, "}\n") >= 0;
+}
+
+segtree_error_t segtree_metrics_export(int fd, const segtree_metrics_t *metrics, segtree_export_format_t format) {
+    if (metrics == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (fd < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    bool ok;
+    switch (format) {
+        case SEGTREE_EXPORT_PROMETHEUS:
+            ok = export_prometheus(fd, metrics);
+            break;
+        case SEGTREE_EXPORT_JSON:
+            ok = export_json(fd, metrics);
+            break;
+        default:
+            return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    return ok ? SEGTREE_OK : SEGTREE_ERROR_IO;
+}
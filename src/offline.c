@@ -0,0 +1,166 @@
+#include "../include/segment_tree.h"
+
+static inline int combine_offline(const segment_tree_t *st, int a, int b) {
+    switch (st->op_type) {
+        case SEGTREE_SUM:
+            return a + b;
+        case SEGTREE_MIN:
+            return (a < b) ? a : b;
+        case SEGTREE_MAX:
+            return (a > b) ? a : b;
+        default:
+            return st->combine(a, b);
+    }
+}
+
+/* Plain bottom-up walk; only valid once no tags are pending. */
+static void answer_direct(segment_tree_t *st, const segtree_range_t *ranges, int *results, int count) {
+    for (int i = 0; i < count; i++) {
+        int left_result = st->identity;
+        int right_result = st->identity;
+
+        for (int l = ranges[i].left + st->capacity, r = ranges[i].right + st->capacity + 1; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                left_result = combine_offline(st, left_result, st->tree[l++]);
+            }
+            if (r & 1) {
+                right_result = combine_offline(st, st->tree[--r], right_result);
+            }
+        }
+
+        results[i] = combine_offline(st, left_result, right_result);
+    }
+}
+
+/* SUM is invertible: one prefix pass, then each range is a difference. */
+static bool answer_prefix(segment_tree_t *st, const segtree_range_t *ranges, int *results, int count) {
+    unsigned int *prefix = (unsigned int*)malloc(((size_t)st->size + 1) * sizeof(unsigned int));
+    if (prefix == NULL) {
+        return false;
+    }
+
+    const int *leaves = st->tree + st->capacity;
+    prefix[0] = 0;
+    for (int i = 0; i < st->size; i++) {
+        prefix[i + 1] = prefix[i] + (unsigned int)leaves[i];
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i] = (int)(prefix[ranges[i].right + 1] - prefix[ranges[i].left]);
+    }
+
+    free(prefix);
+    return true;
+}
+
+static inline int find_root(int *parent, int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+/*
+ * MIN/MAX: sweep right endpoints left to right with a monotonic stack. A
+ * popped index is linked to the element that dominated it, so the root of
+ * any left endpoint is the position of the extreme value in [left, i].
+ */
+static bool answer_stack(segment_tree_t *st, const segtree_range_t *ranges, int *results, int count) {
+    int n = st->size;
+    int *parent = (int*)malloc((size_t)n * sizeof(int));
+    int *stack = (int*)malloc((size_t)n * sizeof(int));
+    int *head = (int*)malloc((size_t)n * sizeof(int));
+    int *next = (int*)malloc((size_t)count * sizeof(int));
+
+    if (parent == NULL || stack == NULL || head == NULL || next == NULL) {
+        free(parent);
+        free(stack);
+        free(head);
+        free(next);
+        return false;
+    }
+
+    for (int i = 0; i < n; i++) {
+        head[i] = -1;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        next[i] = head[ranges[i].right];
+        head[ranges[i].right] = i;
+    }
+
+    const int *leaves = st->tree + st->capacity;
+    bool is_min = (st->op_type == SEGTREE_MIN);
+    int top = 0;
+
+    for (int i = 0; i < n; i++) {
+        int value = leaves[i];
+        while (top > 0 && (is_min ? value <= leaves[stack[top - 1]] : value >= leaves[stack[top - 1]])) {
+            parent[stack[--top]] = i;
+        }
+        stack[top++] = i;
+        parent[i] = i;
+
+        for (int query = head[i]; query >= 0; query = next[query]) {
+            results[query] = leaves[find_root(parent, ranges[query].left)];
+        }
+    }
+
+    free(parent);
+    free(stack);
+    free(head);
+    free(next);
+    return true;
+}
+
+segtree_error_t segtree_query_offline(segment_tree_t *st, const segtree_range_t *ranges, int *results, int count) {
+    if (st == NULL || ranges == NULL || results == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (ranges[i].left < 0 || ranges[i].right >= st->size || ranges[i].left > ranges[i].right) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    segtree_push_all(st);
+
+    /* The sweeps cost O(n + q); below that, q independent O(log n) walks win. */
+    int height = 1;
+    while ((1 << height) < st->capacity) {
+        height++;
+    }
+    bool sweep = (long long)count * 2 * height >= st->size;
+
+    bool done = false;
+    if (sweep && st->op_type == SEGTREE_SUM) {
+        done = answer_prefix(st, ranges, results, count);
+    } else if (sweep && (st->op_type == SEGTREE_MIN || st->op_type == SEGTREE_MAX)) {
+        done = answer_stack(st, ranges, results, count);
+    }
+
+    if (!done) {
+        answer_direct(st, ranges, results, count);
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count += count;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_QUERY, end_time - start_time, count);
+
+    return SEGTREE_OK;
+}
@@ -17,7 +17,11 @@ void update_lazy_sum(segment_tree_t *st, int node, int start, int end, int val)
         return;
     }
 
-    st->lazy[node] += val;
+    st->tree[node] += val * (end - start + 1);
+
+    if (start != end) {
+        st->lazy[node] += val;
+    }
 }
 
 void update_lazy_min(segment_tree_t *st, int node, int start, int end, int val) {
@@ -25,21 +29,15 @@ void update_lazy_min(segment_tree_t *st, int node, int start, int end, int val)
         return;
     }
 
-    if (st->lazy[node] == SEGTREE_INF || val < st->lazy[node]) {
+    st->tree[node] = val;
+
+    if (start != end) {
         st->lazy[node] = val;
-        st->tree[node] = val;
     }
 }
 
 void update_lazy_max(segment_tree_t *st, int node, int start, int end, int val) {
-    if (st == NULL || st->tree == NULL || st->lazy == NULL) {
-        return;
-    }
-
-    if (st->lazy[node] == SEGTREE_NEG_INF || val > st->lazy[node]) {
-        st->lazy[node] = val;
-        st->tree[node] = val;
-    }
+    update_lazy_min(st, node, start, end, val);
 }
 
 void propagate_sum(segment_tree_t *st, int node, int start, int end) {
@@ -47,14 +45,10 @@ void propagate_sum(segment_tree_t *st, int node, int start, int end) {
         return;
     }
 
-    if (st->lazy[node] != 0) {
-        st->tree[node] += st->lazy[node] * (end - start + 1);
-
-        if (start != end) {
-            st->lazy[2 * node] += st->lazy[node];
-            st->lazy[2 * node + 1] += st->lazy[node];
-        }
-
+    if (st->lazy[node] != 0 && start != end) {
+        int mid = (start + end) / 2;
+        update_lazy_sum(st, 2 * node, start, mid, st->lazy[node]);
+        update_lazy_sum(st, 2 * node + 1, mid + 1, end, st->lazy[node]);
         st->lazy[node] = 0;
     }
 }
@@ -64,14 +58,10 @@ void propagate_min(segment_tree_t *st, int node, int start, int end) {
         return;
     }
 
-    if (st->lazy[node] != SEGTREE_INF) {
-        st->tree[node] = st->lazy[node];
-
-        if (start != end) {
-            st->lazy[2 * node] = st->lazy[node];
-            st->lazy[2 * node + 1] = st->lazy[node];
-        }
-
+    if (st->lazy[node] != SEGTREE_INF && start != end) {
+        int mid = (start + end) / 2;
+        update_lazy_min(st, 2 * node, start, mid, st->lazy[node]);
+        update_lazy_min(st, 2 * node + 1, mid + 1, end, st->lazy[node]);
         st->lazy[node] = SEGTREE_INF;
     }
 }
@@ -81,14 +71,10 @@ void propagate_max(segment_tree_t *st, int node, int start, int end) {
         return;
     }
 
-    if (st->lazy[node] != SEGTREE_NEG_INF) {
-        st->tree[node] = st->lazy[node];
-
-        if (start != end) {
-            st->lazy[2 * node] = st->lazy[node];
-            st->lazy[2 * node + 1] = st->lazy[node];
-        }
-
+    if (st->lazy[node] != SEGTREE_NEG_INF && start != end) {
+        int mid = (start + end) / 2;
+        update_lazy_max(st, 2 * node, start, mid, st->lazy[node]);
+        update_lazy_max(st, 2 * node + 1, mid + 1, end, st->lazy[node]);
         st->lazy[node] = SEGTREE_NEG_INF;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,178 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include "../include/segment_tree.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum {
+    PERF_SLOT_CYCLES,
+    PERF_SLOT_INSTRUCTIONS,
+    PERF_SLOT_L1D_MISSES,
+    PERF_SLOT_LLC_MISSES,
+    PERF_SLOT_DTLB_MISSES,
+    PERF_SLOT_COUNT
+};
+
+struct segtree_perf {
+    int fds[PERF_SLOT_COUNT];
+    int group_index[PERF_SLOT_COUNT];
+    int opened;
+    uint64_t start[PERF_SLOT_COUNT];
+};
+
+static int open_counter(uint32_t type, uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (group_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static uint64_t cache_config(uint64_t cache, uint64_t result) {
+    return cache | ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+}
+
+static bool read_group(struct segtree_perf *perf, uint64_t *out) {
+    uint64_t buffer[1 + PERF_SLOT_COUNT];
+
+    ssize_t bytes = read(perf->fds[PERF_SLOT_CYCLES], buffer, sizeof(buffer));
+    if (bytes < (ssize_t)sizeof(uint64_t) || (int)buffer[0] != perf->opened) {
+        return false;
+    }
+
+    for (int slot = 0; slot < PERF_SLOT_COUNT; slot++) {
+        out[slot] = perf->group_index[slot] >= 0 ? buffer[1 + perf->group_index[slot]] : 0;
+    }
+
+    return true;
+}
+
+segtree_error_t segtree_perf_enable(segment_tree_t *st) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (st->perf != NULL) {
+        return SEGTREE_OK;
+    }
+
+    struct segtree_perf *perf = (struct segtree_perf*)malloc(sizeof(struct segtree_perf));
+    if (perf == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    static const struct {
+        uint32_t type;
+        uint64_t config;
+    } events[PERF_SLOT_COUNT] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB}
+    };
+
+    perf->opened = 0;
+    for (int slot = 0; slot < PERF_SLOT_COUNT; slot++) {
+        uint64_t config = events[slot].config;
+        if (events[slot].type == PERF_TYPE_HW_CACHE) {
+            config = cache_config(config, PERF_COUNT_HW_CACHE_RESULT_MISS);
+        }
+
+        int group_fd = (slot == PERF_SLOT_CYCLES) ? -1 : perf->fds[PERF_SLOT_CYCLES];
+        perf->fds[slot] = open_counter(events[slot].type, config, group_fd);
+
+        if (perf->fds[slot] < 0) {
+            if (slot == PERF_SLOT_CYCLES) {
+                free(perf);
+                return SEGTREE_ERROR_INVALID_OPERATION;
+            }
+            perf->group_index[slot] = -1;
+        } else {
+            perf->group_index[slot] = perf->opened++;
+        }
+    }
+
+    ioctl(perf->fds[PERF_SLOT_CYCLES], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(perf->fds[PERF_SLOT_CYCLES], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    st->perf = perf;
+    return SEGTREE_OK;
+}
+
+void segtree_perf_disable(segment_tree_t *st) {
+    if (st == NULL || st->perf == NULL) {
+        return;
+    }
+
+    for (int slot = PERF_SLOT_COUNT - 1; slot >= 0; slot--) {
+        if (st->perf->fds[slot] >= 0) {
+            close(st->perf->fds[slot]);
+        }
+    }
+
+    free(st->perf);
+    st->perf = NULL;
+}
+
+void segtree_perf_begin(segment_tree_t *st) {
+    if (!read_group(st->perf, st->perf->start)) {
+        memset(st->perf->start, 0, sizeof(st->perf->start));
+    }
+}
+
+void segtree_perf_end(segment_tree_t *st, segtree_perf_op_t op) {
+    uint64_t now[PERF_SLOT_COUNT];
+    if (!read_group(st->perf, now)) {
+        return;
+    }
+
+    segtree_perf_counters_t *counters = &st->stats.perf[op];
+    counters->samples++;
+    counters->cycles += now[PERF_SLOT_CYCLES] - st->perf->start[PERF_SLOT_CYCLES];
+    counters->instructions += now[PERF_SLOT_INSTRUCTIONS] - st->perf->start[PERF_SLOT_INSTRUCTIONS];
+    counters->l1d_misses += now[PERF_SLOT_L1D_MISSES] - st->perf->start[PERF_SLOT_L1D_MISSES];
+    counters->llc_misses += now[PERF_SLOT_LLC_MISSES] - st->perf->start[PERF_SLOT_LLC_MISSES];
+    counters->dtlb_misses += now[PERF_SLOT_DTLB_MISSES] - st->perf->start[PERF_SLOT_DTLB_MISSES];
+}
+
+#else
+
+struct segtree_perf {
+    int unused;
+};
+
+segtree_error_t segtree_perf_enable(segment_tree_t *st) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+    return SEGTREE_ERROR_INVALID_OPERATION;
+}
+
+void segtree_perf_disable(segment_tree_t *st) {
+    (void)st;
+}
+
+void segtree_perf_begin(segment_tree_t *st) {
+    (void)st;
+}
+
+void segtree_perf_end(segment_tree_t *st, segtree_perf_op_t op) {
+    (void)st;
+    (void)op;
+}
+
+#endif
@@ -1,4 +1,13 @@
-#include "../include/segment_tree.h"
+#include "wal.h"
+#include "write_buffer.h"
+
+#define SEGTREE_DIFF_BLOCK 16
+
+#if defined(__GNUC__)
+#define SEGTREE_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define SEGTREE_PREFETCH(addr) ((void)(addr))
+#endif
 
 static int calculate_tree_size(int n) {
     int size = 1;
@@ -8,17 +17,6 @@ static int calculate_tree_size(int n) {
     return size * 2;
 }
 
-static void build_tree(segment_tree_t *st, int *arr, int node, int start, int end) {
-    if (start == end) {
-        st->tree[node] = arr[start];
-    } else {
-        int mid = (start + end) / 2;
-        build_tree(st, arr, 2 * node, start, mid);
-        build_tree(st, arr, 2 * node + 1, mid + 1, end);
-        st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
-    }
-}
-
 static void setup_operations(segment_tree_t *st, segtree_operation_t op) {
     switch (op) {
         case SEGTREE_SUM:
@@ -60,8 +58,10 @@ segment_tree_t* segtree_create(int *arr, int n, segtree_operation_t op) {
 
     st->size = n;
     st->tree_size = calculate_tree_size(n);
+    st->capacity = st->tree_size / 2;
     st->op_type = op;
     st->lazy_enabled = false;
+    st->frequency_mode = false;
 
     st->tree = (int*)calloc(st->tree_size, sizeof(int));
     if (st->tree == NULL) {
@@ -74,8 +74,26 @@ segment_tree_t* segtree_create(int *arr, int n, segtree_operation_t op) {
     setup_operations(st, op);
 
     memset(&st->stats, 0, sizeof(segtree_stats_t));
+    st->perf = NULL;
+    st->cache = NULL;
+    st->write_buffer = NULL;
+    st->wal = NULL;
+
+    if (getenv("SEGTREE_PERF") != NULL) {
+        segtree_perf_enable(st);
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    segtree_build_bottom_up(st, arr, n);
 
-    build_tree(st, arr, 1, 0, n - 1);
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_BUILD);
+    }
+    segtree_metrics_record(SEGTREE_PERF_BUILD, segtree_clock_ns() - start_time);
 
     return st;
 }
@@ -94,8 +112,10 @@ segment_tree_t* segtree_create_custom(int *arr, int n,
 
     st->size = n;
     st->tree_size = calculate_tree_size(n);
+    st->capacity = st->tree_size / 2;
     st->op_type = SEGTREE_CUSTOM;
     st->lazy_enabled = false;
+    st->frequency_mode = false;
 
     st->tree = (int*)calloc(st->tree_size, sizeof(int));
     if (st->tree == NULL) {
@@ -110,8 +130,12 @@ segment_tree_t* segtree_create_custom(int *arr, int n,
     st->identity = identity;
 
     memset(&st->stats, 0, sizeof(segtree_stats_t));
+    st->perf = NULL;
+    st->cache = NULL;
+    st->write_buffer = NULL;
+    st->wal = NULL;
 
-    build_tree(st, arr, 1, 0, n - 1);
+    segtree_build_bottom_up(st, arr, n);
 
     return st;
 }
@@ -125,8 +149,7 @@ segment_tree_t* segtree_create_lazy(int *arr, int n, segtree_operation_t op) {
     st->lazy_enabled = true;
     st->lazy = (int*)calloc(st->tree_size, sizeof(int));
     if (st->lazy == NULL) {
-        free(st->tree);
-        free(st);
+        segtree_destroy(st);
         return NULL;
     }
 
@@ -148,27 +171,111 @@ void segtree_destroy(segment_tree_t *st) {
     if (st->lazy != NULL) {
         free(st->lazy);
     }
+    segtree_perf_disable(st);
+    segtree_cache_disable(st);
+    segtree_write_buffer_drop(st);
+    segtree_write_buffer_disable(st);
+    segtree_wal_disable(st);
     free(st);
 }
 
-static int query_recursive(segment_tree_t *st, int node, int start, int end, int l, int r) {
-    if (r < start || end < l) {
-        return st->identity;
+static inline int combine_values(const segment_tree_t *st, int a, int b) {
+    switch (st->op_type) {
+        case SEGTREE_SUM:
+            return a + b;
+        case SEGTREE_MIN:
+            return (a < b) ? a : b;
+        case SEGTREE_MAX:
+            return (a > b) ? a : b;
+        default:
+            return st->combine(a, b);
+    }
+}
+
+static inline int tree_height(const segment_tree_t *st) {
+    int height = 0;
+    while ((1 << height) < st->capacity) {
+        height++;
+    }
+    return height;
+}
+
+/* Lazy tags are pending for the children only: tree[node] already
+ * includes the tag stored in lazy[node]. SUM tags add, MIN/MAX tags assign. */
+static inline void apply_tag(segment_tree_t *st, int node, int len, int val) {
+    if (st->op_type == SEGTREE_MIN || st->op_type == SEGTREE_MAX) {
+        st->tree[node] = val;
+        if (node < st->capacity) {
+            st->lazy[node] = val;
+        }
+    } else {
+        st->tree[node] += val * len;
+        if (node < st->capacity) {
+            st->lazy[node] += val;
+        }
+    }
+}
+
+static inline void push_node(segment_tree_t *st, int node, int len) {
+    int tag = st->lazy[node];
+    if (tag != st->identity) {
+        apply_tag(st, 2 * node, len / 2, tag);
+        apply_tag(st, 2 * node + 1, len / 2, tag);
+        st->lazy[node] = st->identity;
     }
+}
+
+static void push_path(segment_tree_t *st, int leaf) {
+    for (int h = tree_height(st); h > 0; h--) {
+        push_node(st, leaf >> h, 1 << h);
+    }
+}
+
+static void push_boundaries(segment_tree_t *st, int first, int last) {
+    for (int h = tree_height(st); h > 0; h--) {
+        push_node(st, first >> h, 1 << h);
+        if ((last >> h) != (first >> h)) {
+            push_node(st, last >> h, 1 << h);
+        }
+    }
+}
 
-    if (st->lazy_enabled && st->propagate != NULL) {
-        st->propagate(st, node, start, end);
+/* Pushes every pending tag down to the leaves; the tree's values are unchanged. */
+void segtree_push_all(segment_tree_t *st) {
+    if (st == NULL || !st->lazy_enabled) {
+        return;
+    }
+
+    int len = st->capacity;
+    for (int width = 1; width < st->capacity; width *= 2, len /= 2) {
+        for (int node = width; node < 2 * width; node++) {
+            push_node(st, node, len);
+        }
     }
+}
+
+static inline void refresh_node(segment_tree_t *st, int node, int len) {
+    int value = combine_values(st, st->tree[2 * node], st->tree[2 * node + 1]);
 
-    if (l <= start && end <= r) {
-        return st->tree[node];
+    if (st->lazy_enabled && st->lazy[node] != st->identity) {
+        if (st->op_type == SEGTREE_MIN || st->op_type == SEGTREE_MAX) {
+            value = st->lazy[node];
+        } else {
+            value += st->lazy[node] * len;
+        }
     }
 
-    int mid = (start + end) / 2;
-    int left_result = query_recursive(st, 2 * node, start, mid, l, r);
-    int right_result = query_recursive(st, 2 * node + 1, mid + 1, end, l, r);
+    st->tree[node] = value;
+}
 
-    return st->combine(left_result, right_result);
+static void pull_boundaries(segment_tree_t *st, int first, int last) {
+    int len = 2;
+    for (first /= 2, last /= 2; first >= 1; first /= 2, last /= 2, len *= 2) {
+        refresh_node(st, first, len);
+        if (last != first) {
+            refresh_node(st, last, len);
+        }
+    }
 }
 
 segtree_error_t segtree_query(segment_tree_t *st, int left, int right, int *result) {
@@ -180,147 +287,1353 @@ segtree_error_t segtree_query(segment_tree_t *st, int left, int right, int *resu
         return SEGTREE_ERROR_INVALID_RANGE;
     }
 
-    clock_t start_time = clock();
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    /* Hits are timed too, so the histogram reflects what callers see. */
+    if (st->cache != NULL && segtree_cache_lookup(st, left, right, result)) {
+        unsigned long long end_time = segtree_clock_ns();
+        st->stats.query_count++;
+        st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+        segtree_metrics_record(SEGTREE_PERF_QUERY, end_time - start_time);
+        return SEGTREE_OK;
+    }
+
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    int l = left + st->capacity;
+    int r = right + st->capacity + 1;
+
+    if (st->lazy_enabled) {
+        push_boundaries(st, l, r - 1);
+    }
+
+    int left_result = st->identity;
+    int right_result = st->identity;
+
+    for (; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            left_result = combine_values(st, left_result, st->tree[l++]);
+        }
+        if (r & 1) {
+            right_result = combine_values(st, st->tree[--r], right_result);
+        }
+    }
+
+    *result = combine_values(st, left_result, right_result);
 
-    *result = query_recursive(st, 1, 0, st->size - 1, left, right);
+    if (st->cache != NULL) {
+        segtree_cache_store(st, left, right, *result);
+    }
 
-    clock_t end_time = clock();
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_QUERY);
+    }
+    unsigned long long end_time = segtree_clock_ns();
     st->stats.query_count++;
-    st->stats.total_query_time += (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_QUERY, end_time - start_time);
 
     return SEGTREE_OK;
 }
 
-static void update_point_recursive(segment_tree_t *st, int node, int start, int end, int idx, int val) {
-    if (start == end) {
-        st->tree[node] = val;
-    } else {
-        int mid = (start + end) / 2;
-        if (idx <= mid) {
-            update_point_recursive(st, 2 * node, start, mid, idx, val);
-        } else {
-            update_point_recursive(st, 2 * node + 1, mid + 1, end, idx, val);
+/* Leftmost (or rightmost) node in the subtree under node whose value is target. */
+static int descend_to_target(segment_tree_t *st, int node, int len, int target, segtree_tie_t tie) {
+    while (node < st->capacity) {
+        if (st->lazy_enabled) {
+            push_node(st, node, len);
         }
-        st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
+        len /= 2;
+
+        int first = (tie == SEGTREE_TIE_LEFTMOST) ? 2 * node : 2 * node + 1;
+        node = (st->tree[first] == target) ? first : (first ^ 1);
     }
+    return node - st->capacity;
 }
 
-segtree_error_t segtree_update_point(segment_tree_t *st, int index, int value) {
-    if (st == NULL) {
+segtree_error_t segtree_query_arg(segment_tree_t *st, int left, int right, int *value, int *index,
+                                  segtree_tie_t tie) {
+    if (st == NULL || value == NULL || index == NULL) {
         return SEGTREE_ERROR_NULL_POINTER;
     }
 
-    if (index < 0 || index >= st->size) {
+    if (st->op_type != SEGTREE_MIN && st->op_type != SEGTREE_MAX) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (left < 0 || right >= st->size || left > right) {
         return SEGTREE_ERROR_INVALID_RANGE;
     }
 
-    clock_t start_time = clock();
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
 
-    update_point_recursive(st, 1, 0, st->size - 1, index, value);
+    int l = left + st->capacity;
+    int r = right + st->capacity + 1;
 
-    clock_t end_time = clock();
-    st->stats.update_count++;
-    st->stats.total_update_time += (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    if (st->lazy_enabled) {
+        push_boundaries(st, l, r - 1);
+    }
+
+    /* The canonical cover of [left, right], in position order. */
+    int nodes[64];
+    int lens[64];
+    int left_count = 0;
+    int right_count = 0;
+    int right_nodes[32];
+    int right_lens[32];
+
+    for (int len = 1; l < r; l /= 2, r /= 2, len *= 2) {
+        if (l & 1) {
+            nodes[left_count] = l++;
+            lens[left_count++] = len;
+        }
+        if (r & 1) {
+            right_nodes[right_count] = --r;
+            right_lens[right_count++] = len;
+        }
+    }
+
+    int count = left_count;
+    while (right_count > 0) {
+        right_count--;
+        nodes[count] = right_nodes[right_count];
+        lens[count++] = right_lens[right_count];
+    }
+
+    int best = st->identity;
+    for (int i = 0; i < count; i++) {
+        best = combine_values(st, best, st->tree[nodes[i]]);
+    }
+
+    int pick = 0;
+    if (tie == SEGTREE_TIE_LEFTMOST) {
+        while (st->tree[nodes[pick]] != best) {
+            pick++;
+        }
+    } else {
+        pick = count - 1;
+        while (st->tree[nodes[pick]] != best) {
+            pick--;
+        }
+    }
+
+    *value = best;
+    *index = descend_to_target(st, nodes[pick], lens[pick], best, tie);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count++;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_QUERY, end_time - start_time);
 
     return SEGTREE_OK;
 }
 
-static void update_range_recursive(segment_tree_t *st, int node, int start, int end, int l, int r, int val) {
-    if (st->lazy_enabled && st->propagate != NULL) {
-        st->propagate(st, node, start, end);
-    }
+/* Leaf value including the SUM tags still pending on its ancestors. */
+static int effective_leaf(const segment_tree_t *st, int index) {
+    int leaf = index + st->capacity;
+    int value = st->tree[leaf];
 
-    if (start > r || end < l) {
-        return;
+    if (st->lazy_enabled) {
+        for (int node = leaf / 2; node >= 1; node /= 2) {
+            value += st->lazy[node];
+        }
     }
+    return value;
+}
 
-    if (start >= l && end <= r) {
-        if (st->lazy_enabled && st->update_lazy != NULL) {
-            st->update_lazy(st, node, start, end, val);
-            if (st->propagate != NULL) {
-                st->propagate(st, node, start, end);
-            }
-        } else {
-            st->tree[node] = val;
+static bool all_nonnegative(const int *values, int count) {
+    for (int i = 0; i < count; i++) {
+        if (values[i] < 0) {
+            return false;
         }
-        return;
+    }
+    return true;
+}
+
+/* Rejects range adds that would drive a count negative. Only the span of
+ * the ranges is scanned, and only when some range subtracts. */
+segtree_error_t segtree_frequency_check(segment_tree_t *st, const int *lefts, const int *rights,
+                                        const int *values, int count) {
+    if (!st->frequency_mode || all_nonnegative(values, count)) {
+        return SEGTREE_OK;
+    }
+
+    int lo = st->size;
+    int hi = -1;
+    for (int i = 0; i < count; i++) {
+        lo = lefts[i] < lo ? lefts[i] : lo;
+        hi = rights[i] > hi ? rights[i] : hi;
+    }
+
+    long long *diff = (long long*)calloc((size_t)(hi - lo) + 2, sizeof(long long));
+    if (diff == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
     }
 
-    int mid = (start + end) / 2;
-    update_range_recursive(st, 2 * node, start, mid, l, r, val);
-    update_range_recursive(st, 2 * node + 1, mid + 1, end, l, r, val);
+    for (int i = 0; i < count; i++) {
+        diff[lefts[i] - lo] += values[i];
+        diff[rights[i] - lo + 1] -= values[i];
+    }
 
-    if (st->lazy_enabled && st->propagate != NULL) {
-        st->propagate(st, 2 * node, start, mid);
-        st->propagate(st, 2 * node + 1, mid + 1, end);
+    bool ok = true;
+    long long delta = 0;
+    for (int i = lo; i <= hi && ok; i++) {
+        delta += diff[i - lo];
+        ok = (long long)effective_leaf(st, i) + delta >= 0;
     }
 
-    st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
+    free(diff);
+    return ok ? SEGTREE_OK : SEGTREE_ERROR_INVALID_OPERATION;
 }
 
-segtree_error_t segtree_update_range(segment_tree_t *st, int left, int right, int value) {
+segtree_error_t segtree_set_frequency_mode(segment_tree_t *st, bool enabled) {
     if (st == NULL) {
         return SEGTREE_ERROR_NULL_POINTER;
     }
 
-    if (!st->lazy_enabled) {
+    if (!enabled) {
+        st->frequency_mode = false;
+        return SEGTREE_OK;
+    }
+
+    if (st->op_type != SEGTREE_SUM) {
         return SEGTREE_ERROR_INVALID_OPERATION;
     }
 
-    if (left < 0 || right >= st->size || left > right) {
-        return SEGTREE_ERROR_INVALID_RANGE;
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    for (int i = 0; i < st->size; i++) {
+        if (effective_leaf(st, i) < 0) {
+            return SEGTREE_ERROR_INVALID_OPERATION;
+        }
     }
 
-    clock_t start_time = clock();
+    st->frequency_mode = true;
+    return SEGTREE_OK;
+}
 
-    update_range_recursive(st, 1, 0, st->size - 1, left, right, value);
+/* Frequency mode keeps every leaf a non-negative count, so descending by
+ * prefix sums replaces binary-searching segtree_query. */
+static segtree_error_t check_frequency_tree(segment_tree_t *st) {
+    if (!st->frequency_mode) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
 
-    clock_t end_time = clock();
-    st->stats.update_count++;
-    st->stats.total_update_time += (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
 
     return SEGTREE_OK;
 }
 
-segtree_error_t segtree_rebuild(segment_tree_t *st, int *new_arr, int new_size) {
-    if (st == NULL || new_arr == NULL) {
+static int kth_leaf(segment_tree_t *st, int k) {
+    int node = 1;
+    for (int len = st->capacity; node < st->capacity; len /= 2) {
+        if (st->lazy_enabled) {
+            push_node(st, node, len);
+        }
+        if (st->tree[2 * node] >= k) {
+            node = 2 * node;
+        } else {
+            k -= st->tree[2 * node];
+            node = 2 * node + 1;
+        }
+    }
+    return node - st->capacity;
+}
+
+static int rank_prefix(segment_tree_t *st, int x) {
+    if (x >= st->size) {
+        return st->tree[1];
+    }
+
+    int count = 0;
+    int node = 1;
+    for (int len = st->capacity, low = 0; node < st->capacity; len /= 2) {
+        if (st->lazy_enabled) {
+            push_node(st, node, len);
+        }
+        if (x >= low + len / 2) {
+            count += st->tree[2 * node];
+            low += len / 2;
+            node = 2 * node + 1;
+        } else {
+            node = 2 * node;
+        }
+    }
+    return count;
+}
+
+segtree_error_t segtree_kth(segment_tree_t *st, int k, int *index) {
+    if (st == NULL || index == NULL) {
         return SEGTREE_ERROR_NULL_POINTER;
     }
 
-    if (new_size <= 0 || new_size > SEGTREE_MAX_SIZE) {
+    segtree_error_t error = check_frequency_tree(st);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (k < 1 || k > st->tree[1]) {
         return SEGTREE_ERROR_INVALID_RANGE;
     }
 
-    int new_tree_size = calculate_tree_size(new_size);
+    unsigned long long start_time = segtree_clock_ns();
+    *index = kth_leaf(st, k);
 
-    if (new_tree_size != st->tree_size) {
-        int *new_tree = (int*)realloc(st->tree, new_tree_size * sizeof(int));
-        if (new_tree == NULL) {
-            return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count++;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_QUERY, end_time - start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_rank(segment_tree_t *st, int x, int *count) {
+    if (st == NULL || count == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    segtree_error_t error = check_frequency_tree(st);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (x < 0 || x > st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    *count = rank_prefix(st, x);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count++;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_QUERY, end_time - start_time);
+
+    return SEGTREE_OK;
+}
+
+typedef struct {
+    int key;
+    int position;
+} keyed_query_t;
+
+static int compare_keyed(const void *a, const void *b) {
+    const keyed_query_t *qa = (const keyed_query_t*)a;
+    const keyed_query_t *qb = (const keyed_query_t*)b;
+    if (qa->key != qb->key) {
+        return (qa->key > qb->key) - (qa->key < qb->key);
+    }
+    return qa->position - qb->position;
+}
+
+/* Sorts a batch by key so its members can share one descent. */
+static keyed_query_t* sort_batch(const int *keys, int count) {
+    keyed_query_t *batch = (keyed_query_t*)malloc((size_t)count * sizeof(keyed_query_t));
+    if (batch == NULL) {
+        return NULL;
+    }
+
+    bool sorted = true;
+    for (int i = 0; i < count; i++) {
+        batch[i].key = keys[i];
+        batch[i].position = i;
+        if (i > 0 && keys[i] < keys[i - 1]) {
+            sorted = false;
         }
-        st->tree = new_tree;
+    }
 
-        if (st->lazy_enabled) {
-            int *new_lazy = (int*)realloc(st->lazy, new_tree_size * sizeof(int));
-            if (new_lazy == NULL) {
-                return SEGTREE_ERROR_MEMORY_ALLOCATION;
-            }
-            st->lazy = new_lazy;
-            for (int i = 0; i < new_tree_size; i++) {
-                st->lazy[i] = st->identity;
-            }
+    if (!sorted) {
+        qsort(batch, count, sizeof(keyed_query_t), compare_keyed);
+    }
+    return batch;
+}
+
+/* First position in [lo, hi) whose key is at least bound. */
+static int lower_bound_key(const keyed_query_t *batch, int lo, int hi, int bound) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (batch[mid].key < bound) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
+    }
+    return lo;
+}
 
-        st->tree_size = new_tree_size;
+/* Sends batch[lo, hi) down the subtree at node; ranks there are key - base. */
+static void kth_descend(segment_tree_t *st, int node, int len, const keyed_query_t *batch,
+                        int lo, int hi, int base, int *indices) {
+    if (lo >= hi) {
+        return;
     }
 
-    st->size = new_size;
+    if (node >= st->capacity) {
+        for (int i = lo; i < hi; i++) {
+            indices[batch[i].position] = node - st->capacity;
+        }
+        return;
+    }
 
-    for (int i = 0; i < st->tree_size; i++) {
-        st->tree[i] = st->identity;
+    if (st->lazy_enabled) {
+        push_node(st, node, len);
+    }
+
+    int left_sum = st->tree[2 * node];
+    int split = lower_bound_key(batch, lo, hi, base + left_sum + 1);
+
+    kth_descend(st, 2 * node, len / 2, batch, lo, split, base, indices);
+    kth_descend(st, 2 * node + 1, len / 2, batch, split, hi, base + left_sum, indices);
+}
+
+static void rank_descend(segment_tree_t *st, int node, int len, int low, const keyed_query_t *batch,
+                         int lo, int hi, int base, int *counts) {
+    if (lo >= hi) {
+        return;
+    }
+
+    if (node >= st->capacity) {
+        for (int i = lo; i < hi; i++) {
+            counts[batch[i].position] = base;
+        }
+        return;
+    }
+
+    if (st->lazy_enabled) {
+        push_node(st, node, len);
+    }
+
+    int split = lower_bound_key(batch, lo, hi, low + len / 2);
+
+    rank_descend(st, 2 * node, len / 2, low, batch, lo, split, base, counts);
+    rank_descend(st, 2 * node + 1, len / 2, low + len / 2, batch, split, hi,
+                 base + st->tree[2 * node], counts);
+}
+
+segtree_error_t segtree_kth_batch(segment_tree_t *st, const int *ks, int *indices, int count) {
+    if (st == NULL || ks == NULL || indices == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    segtree_error_t error = check_frequency_tree(st);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (ks[i] < 1 || ks[i] > st->tree[1]) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    keyed_query_t *batch = sort_batch(ks, count);
+    if (batch == NULL && count > 0) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    kth_descend(st, 1, st->capacity, batch, 0, count, 0, indices);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count += count;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_QUERY, end_time - start_time, count);
+
+    free(batch);
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_rank_batch(segment_tree_t *st, const int *xs, int *counts, int count) {
+    if (st == NULL || xs == NULL || counts == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    segtree_error_t error = check_frequency_tree(st);
+    if (error != SEGTREE_OK) {
+        return error;
     }
 
-    build_tree(st, new_arr, 1, 0, new_size - 1);
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (xs[i] < 0 || xs[i] > st->size) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    keyed_query_t *batch = sort_batch(xs, count);
+    if (batch == NULL && count > 0) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    /* x == size is the total, and size may equal capacity (no leaf to reach). */
+    int descend = count;
+    while (descend > 0 && batch[descend - 1].key == st->size) {
+        counts[batch[--descend].position] = st->tree[1];
+    }
+
+    rank_descend(st, 1, st->capacity, 0, batch, 0, descend, 0, counts);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count += count;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_QUERY, end_time - start_time, count);
+
+    free(batch);
+    return SEGTREE_OK;
+}
+
+typedef struct {
+    int l;
+    int r;
+    int left_result;
+    int right_result;
+    int query;
+} batch_slot_t;
+
+static inline void batch_start(segment_tree_t *st, batch_slot_t *slot, int query, int left, int right) {
+    slot->l = left + st->capacity;
+    slot->r = right + st->capacity + 1;
+    slot->left_result = st->identity;
+    slot->right_result = st->identity;
+    slot->query = query;
+    SEGTREE_PREFETCH(&st->tree[slot->l]);
+    SEGTREE_PREFETCH(&st->tree[slot->r - 1]);
+}
+
+/* Interleaved (AMAC-style) bottom-up queries: each slot advances one level,
+ * prefetches the nodes it needs next and yields to the other slots, so up
+ * to 2 * SEGTREE_BATCH_GROUP cache misses are in flight at once. Both
+ * boundary nodes are always loaded and selected without branches, since
+ * the parity tests are unpredictable. */
+static inline void query_batch_interleaved(segment_tree_t *st, segtree_operation_t op,
+                                           int *lefts, int *rights, int *results, int count) {
+    batch_slot_t slots[SEGTREE_BATCH_GROUP];
+    int active = 0;
+    int next = 0;
+
+    while (active < SEGTREE_BATCH_GROUP && next < count) {
+        batch_start(st, &slots[active++], next, lefts[next], rights[next]);
+        next++;
+    }
+
+    while (active > 0) {
+        for (int i = 0; i < active; i++) {
+            batch_slot_t *slot = &slots[i];
+            int l = slot->l;
+            int r = slot->r;
+            int take_left = l & 1;
+            int take_right = r & 1;
+            int left_value = st->tree[l];
+            int right_value = st->tree[r - 1];
+
+            if (op == SEGTREE_SUM) {
+                slot->left_result += take_left ? left_value : 0;
+                slot->right_result += take_right ? right_value : 0;
+            } else if (op == SEGTREE_MIN) {
+                int left_min = combine_min(slot->left_result, left_value);
+                int right_min = combine_min(right_value, slot->right_result);
+                slot->left_result = take_left ? left_min : slot->left_result;
+                slot->right_result = take_right ? right_min : slot->right_result;
+            } else if (op == SEGTREE_MAX) {
+                int left_max = combine_max(slot->left_result, left_value);
+                int right_max = combine_max(right_value, slot->right_result);
+                slot->left_result = take_left ? left_max : slot->left_result;
+                slot->right_result = take_right ? right_max : slot->right_result;
+            } else {
+                if (take_left) {
+                    slot->left_result = st->combine(slot->left_result, left_value);
+                }
+                if (take_right) {
+                    slot->right_result = st->combine(right_value, slot->right_result);
+                }
+            }
+
+            l = (l + take_left) / 2;
+            r = (r - take_right) / 2;
+            slot->l = l;
+            slot->r = r;
+
+            if (l < r) {
+                SEGTREE_PREFETCH(&st->tree[l]);
+                SEGTREE_PREFETCH(&st->tree[r - 1]);
+                continue;
+            }
+
+            results[slot->query] = combine_values(st, slot->left_result, slot->right_result);
+
+            if (next < count) {
+                batch_start(st, slot, next, lefts[next], rights[next]);
+                next++;
+            } else {
+                slots[i--] = slots[--active];
+            }
+        }
+    }
+}
+
+segtree_error_t segtree_query_batch(segment_tree_t *st, int *lefts, int *rights, int *results, int count) {
+    if (st == NULL || lefts == NULL || rights == NULL || results == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (lefts[i] < 0 || rights[i] >= st->size || lefts[i] > rights[i]) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    /* Lazy queries push tags along their paths, so they stay sequential. */
+    if (st->lazy_enabled) {
+        for (int i = 0; i < count; i++) {
+            segtree_query(st, lefts[i], rights[i], &results[i]);
+        }
+        return SEGTREE_OK;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    switch (st->op_type) {
+        case SEGTREE_SUM:
+            query_batch_interleaved(st, SEGTREE_SUM, lefts, rights, results, count);
+            break;
+        case SEGTREE_MIN:
+            query_batch_interleaved(st, SEGTREE_MIN, lefts, rights, results, count);
+            break;
+        case SEGTREE_MAX:
+            query_batch_interleaved(st, SEGTREE_MAX, lefts, rights, results, count);
+            break;
+        default:
+            query_batch_interleaved(st, SEGTREE_CUSTOM, lefts, rights, results, count);
+            break;
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count += count;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_QUERY, end_time - start_time, count);
+
+    return SEGTREE_OK;
+}
+
+static void set_leaf(segment_tree_t *st, int index, int value) {
+    int leaf = index + st->capacity;
+
+    if (st->lazy_enabled) {
+        push_path(st, leaf);
+    }
+
+    st->tree[leaf] = value;
+    pull_boundaries(st, leaf, leaf);
+}
+
+segtree_error_t segtree_update_point(segment_tree_t *st, int index, int value) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->frequency_mode && value < 0) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (st->write_buffer != NULL) {
+        return segtree_write_buffer_add_point(st, index, value);
+    }
+
+    if (st->wal != NULL) {
+        segtree_error_t error = segtree_wal_log(st, SEGTREE_WAL_POINT, &index, NULL, &value, 1);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    set_leaf(st, index, value);
+
+    if (st->cache != NULL) {
+        segtree_cache_invalidate(st, index, index);
+    }
+
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_UPDATE_POINT);
+    }
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count++;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_UPDATE_POINT, end_time - start_time);
+
+    return SEGTREE_OK;
+}
+
+typedef struct {
+    int index;
+    int value;
+    int order;
+} point_write_t;
+
+static int compare_point_writes(const void *a, const void *b) {
+    const point_write_t *x = (const point_write_t*)a;
+    const point_write_t *y = (const point_write_t*)b;
+    if (x->index != y->index) {
+        return (x->index > y->index) - (x->index < y->index);
+    }
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+static void refresh_ancestors(segment_tree_t *st, int *nodes, int count);
+
+segtree_error_t segtree_update_points(segment_tree_t *st, int *indices, int *values, int count) {
+    if (st == NULL || indices == NULL || values == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (indices[i] < 0 || indices[i] >= st->size) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    if (st->frequency_mode && !all_nonnegative(values, count)) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (count == 0) {
+        return SEGTREE_OK;
+    }
+
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    if (st->wal != NULL) {
+        segtree_error_t error = segtree_wal_log(st, SEGTREE_WAL_POINT, indices, NULL, values, count);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    point_write_t *writes = (point_write_t*)malloc(count * sizeof(point_write_t));
+    int *nodes = (int*)malloc(count * sizeof(int));
+    if (writes == NULL || nodes == NULL) {
+        free(writes);
+        free(nodes);
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    for (int i = 0; i < count; i++) {
+        writes[i].index = indices[i];
+        writes[i].value = values[i];
+        writes[i].order = i;
+    }
+    qsort(writes, count, sizeof(point_write_t), compare_point_writes);
+
+    /* Keep the last write to each index. */
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (i + 1 < count && writes[i + 1].index == writes[i].index) {
+            continue;
+        }
+        writes[unique++] = writes[i];
+    }
+
+    if (st->lazy_enabled) {
+        for (int h = tree_height(st); h > 0; h--) {
+            int previous = 0;
+            for (int i = 0; i < unique; i++) {
+                int node = (writes[i].index + st->capacity) >> h;
+                if (node != previous) {
+                    push_node(st, node, 1 << h);
+                    previous = node;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < unique; i++) {
+        nodes[i] = writes[i].index + st->capacity;
+        st->tree[nodes[i]] = writes[i].value;
+
+        if (st->cache != NULL) {
+            segtree_cache_invalidate(st, writes[i].index, writes[i].index);
+        }
+    }
+
+    refresh_ancestors(st, nodes, unique);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count += count;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_UPDATE_POINT, end_time - start_time, count);
+
+    free(writes);
+    free(nodes);
+
+    return SEGTREE_OK;
+}
+
+static void apply_range(segment_tree_t *st, int left, int right, int value) {
+    int first = left + st->capacity;
+    int last = right + st->capacity;
+
+    push_boundaries(st, first, last);
+
+    int len = 1;
+    for (int l = first, r = last + 1; l < r; l /= 2, r /= 2, len *= 2) {
+        if (l & 1) {
+            apply_tag(st, l++, len, value);
+        }
+        if (r & 1) {
+            apply_tag(st, --r, len, value);
+        }
+    }
+
+    pull_boundaries(st, first, last);
+
+    if (st->cache != NULL) {
+        segtree_cache_invalidate(st, left, right);
+    }
+}
+
+segtree_error_t segtree_update_range(segment_tree_t *st, int left, int right, int value) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (!st->lazy_enabled) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (left < 0 || right >= st->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->write_buffer != NULL) {
+        if (st->op_type == SEGTREE_SUM) {
+            return segtree_write_buffer_add_range(st, left, right, value);
+        }
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    segtree_error_t error = segtree_frequency_check(st, &left, &right, &value, 1);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (st->wal != NULL) {
+        error = segtree_wal_log(st, SEGTREE_WAL_RANGE, &left, &right, &value, 1);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    apply_range(st, left, right, value);
+
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_UPDATE_RANGE);
+    }
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count++;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record(SEGTREE_PERF_UPDATE_RANGE, end_time - start_time);
+
+    return SEGTREE_OK;
+}
+
+/* SUM: accumulate every add in a difference array and fold it into the leaves. */
+static bool bulk_add_leaves(segment_tree_t *st, int *lefts, int *rights, int *values, int count) {
+    unsigned int *diff = (unsigned int*)calloc((size_t)st->size + 1, sizeof(unsigned int));
+    if (diff == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        diff[lefts[i]] += (unsigned int)values[i];
+        diff[rights[i] + 1] -= (unsigned int)values[i];
+    }
+
+    int *leaves = st->tree + st->capacity;
+    unsigned int running = 0;
+    for (int i = 0; i < st->size; i++) {
+        running += diff[i];
+        leaves[i] = (int)((unsigned int)leaves[i] + running);
+    }
+
+    free(diff);
+    return true;
+}
+
+/* MIN/MAX: assignments are applied newest first and each leaf is painted
+ * once; next[i] skips to the first unpainted position at or after i. */
+static bool bulk_assign_leaves(segment_tree_t *st, int *lefts, int *rights, int *values, int count) {
+    int *next = (int*)malloc(((size_t)st->size + 1) * sizeof(int));
+    if (next == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i <= st->size; i++) {
+        next[i] = i;
+    }
+
+    int *leaves = st->tree + st->capacity;
+    for (int i = count - 1; i >= 0; i--) {
+        int pos = lefts[i];
+        while (true) {
+            int root = pos;
+            while (next[root] != root) {
+                next[root] = next[next[root]];
+                root = next[root];
+            }
+            if (root > rights[i]) {
+                break;
+            }
+            leaves[root] = values[i];
+            next[root] = root + 1;
+            pos = root + 1;
+        }
+    }
+
+    free(next);
+    return true;
+}
+
+segtree_error_t segtree_update_ranges(segment_tree_t *st, int *lefts, int *rights, int *values, int count,
+                                      segtree_bulk_path_t *path) {
+    if (path != NULL) {
+        *path = SEGTREE_BULK_NONE;
+    }
+
+    if (st == NULL || lefts == NULL || rights == NULL || values == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (!st->lazy_enabled) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (count < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (lefts[i] < 0 || rights[i] >= st->size || lefts[i] > rights[i]) {
+            return SEGTREE_ERROR_INVALID_RANGE;
+        }
+    }
+
+    if (count == 0) {
+        return SEGTREE_OK;
+    }
+
+    if (st->write_buffer != NULL) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    segtree_error_t error = segtree_frequency_check(st, lefts, rights, values, count);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (st->wal != NULL) {
+        error = segtree_wal_log(st, SEGTREE_WAL_RANGE, lefts, rights, values, count);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    /* A lazy range costs about SEGTREE_BULK_RANGE_COST streamed node visits per
+     * level (its pushes and pulls are scattered); the bulk path streams over
+     * every node about twice. */
+    long long lazy_cost = (long long)count * SEGTREE_BULK_RANGE_COST * (tree_height(st) + 1);
+    long long bulk_cost = 2LL * st->tree_size;
+    bool bulk = false;
+
+    if (lazy_cost > bulk_cost) {
+        segtree_push_all(st);
+        if (st->op_type == SEGTREE_SUM) {
+            bulk = bulk_add_leaves(st, lefts, rights, values, count);
+        } else {
+            bulk = bulk_assign_leaves(st, lefts, rights, values, count);
+        }
+    }
+
+    if (bulk) {
+        segtree_build_internal(st);
+        if (st->cache != NULL) {
+            segtree_cache_invalidate_all(st);
+        }
+    } else {
+        /* Also the fallback when the scratch array cannot be allocated. */
+        for (int i = 0; i < count; i++) {
+            apply_range(st, lefts[i], rights[i], values[i]);
+        }
+    }
+
+    if (path != NULL) {
+        *path = bulk ? SEGTREE_BULK_REBUILD : SEGTREE_BULK_LAZY;
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count += count;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_UPDATE_RANGE, end_time - start_time, count);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_rebuild(segment_tree_t *st, int *new_arr, int new_size) {
+    if (st == NULL || new_arr == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (new_size <= 0 || new_size > SEGTREE_MAX_SIZE) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->frequency_mode && !all_nonnegative(new_arr, new_size)) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    int new_tree_size = calculate_tree_size(new_size);
+
+    if (st->write_buffer != NULL) {
+        segtree_write_buffer_drop(st);
+    }
+
+    if (new_tree_size != st->tree_size) {
+        int *new_tree = (int*)realloc(st->tree, new_tree_size * sizeof(int));
+        if (new_tree == NULL) {
+            return SEGTREE_ERROR_MEMORY_ALLOCATION;
+        }
+        st->tree = new_tree;
+
+        if (st->lazy_enabled) {
+            int *new_lazy = (int*)realloc(st->lazy, new_tree_size * sizeof(int));
+            if (new_lazy == NULL) {
+                return SEGTREE_ERROR_MEMORY_ALLOCATION;
+            }
+            st->lazy = new_lazy;
+        }
+
+        st->tree_size = new_tree_size;
+        st->capacity = new_tree_size / 2;
+    }
+
+    st->size = new_size;
+
+    if (st->lazy_enabled) {
+        for (int i = 0; i < st->tree_size; i++) {
+            st->lazy[i] = st->identity;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    segtree_build_bottom_up(st, new_arr, new_size);
+
+    if (st->cache != NULL) {
+        segtree_cache_invalidate_all(st);
+    }
+
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_BUILD);
+    }
+    segtree_metrics_record(SEGTREE_PERF_BUILD, segtree_clock_ns() - start_time);
+
+    /* A rebuild is not logged; the new contents become the snapshot. */
+    return segtree_wal_checkpoint(st);
+}
+
+static void refresh_ancestors(segment_tree_t *st, int *nodes, int count) {
+    int len = 2;
+    while (count > 0 && nodes[0] > 1) {
+        int unique = 0;
+        for (int i = 0; i < count; i++) {
+            int parent = nodes[i] / 2;
+            if (unique == 0 || nodes[unique - 1] != parent) {
+                nodes[unique++] = parent;
+                refresh_node(st, parent, len);
+            }
+        }
+        count = unique;
+        len *= 2;
+    }
+}
+
+segtree_error_t segtree_rebuild_diff(segment_tree_t *st, int *new_arr, int n) {
+    if (st == NULL || new_arr == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (n <= 0 || n > SEGTREE_MAX_SIZE) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->frequency_mode && !all_nonnegative(new_arr, n)) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (st->write_buffer != NULL) {
+        segtree_write_buffer_drop(st);
+    }
+
+    /* Leaves under pending lazy tags are stale, so they cannot be diffed. */
+    if (n != st->size || st->lazy_enabled) {
+        return segtree_rebuild(st, new_arr, n);
+    }
+
+    int threshold = n / SEGTREE_DIFF_FULL_REBUILD_RATIO;
+    int *changed = (int*)malloc((threshold + 1) * sizeof(int));
+    if (changed == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    if (st->perf != NULL) {
+        segtree_perf_begin(st);
+    }
+
+    int *leaves = st->tree + st->capacity;
+    int count = 0;
+    bool dense = false;
+
+    for (int block = 0; block < n; block += SEGTREE_DIFF_BLOCK) {
+        int len = n - block < SEGTREE_DIFF_BLOCK ? n - block : SEGTREE_DIFF_BLOCK;
+
+        if (memcmp(leaves + block, new_arr + block, len * sizeof(int)) == 0) {
+            continue;
+        }
+
+        if (dense) {
+            memcpy(leaves + block, new_arr + block, len * sizeof(int));
+            continue;
+        }
+
+        for (int i = block; i < block + len; i++) {
+            if (leaves[i] != new_arr[i]) {
+                leaves[i] = new_arr[i];
+                if (count == threshold) {
+                    dense = true;
+                } else {
+                    changed[count++] = st->capacity + i;
+                }
+            }
+        }
+    }
+
+    if (dense) {
+        segtree_build_internal(st);
+    } else {
+        refresh_ancestors(st, changed, count);
+    }
+
+    if (st->cache != NULL) {
+        segtree_cache_invalidate_all(st);
+    }
+
+    if (st->perf != NULL) {
+        segtree_perf_end(st, SEGTREE_PERF_BUILD);
+    }
+    segtree_metrics_record(SEGTREE_PERF_BUILD, segtree_clock_ns() - start_time);
+
+    free(changed);
+
+    return segtree_wal_checkpoint(st);
+}
+
+static void fill_identity(int *data, int from, int to, int identity) {
+    for (int i = from; i < to; i++) {
+        data[i] = identity;
+    }
+}
+
+static void shift_levels(int *data, int capacity, int shift, int identity) {
+    /* Node k at depth d moves to k + 2^d * (2^shift - 1); deepest level first
+     * so that no level is overwritten before it has been moved. */
+    for (int width = capacity; width >= 1; width /= 2) {
+        memmove(data + (width << shift), data + width, width * sizeof(int));
+    }
+
+    for (int width = capacity; width >= 1; width /= 2) {
+        fill_identity(data, (width << shift) + width, width << (shift + 1), identity);
+    }
+
+    fill_identity(data, 1, 1 << shift, identity);
+}
+
+static segtree_error_t grow_capacity(segment_tree_t *st, int min_size) {
+    int new_capacity = st->capacity;
+    int shift = 0;
+    while (new_capacity < min_size) {
+        new_capacity *= 2;
+        shift++;
+    }
+
+    if (shift == 0) {
+        return SEGTREE_OK;
+    }
+
+    int new_tree_size = new_capacity * 2;
+
+    int *new_tree = (int*)realloc(st->tree, new_tree_size * sizeof(int));
+    if (new_tree == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+    st->tree = new_tree;
+
+    if (st->lazy_enabled) {
+        int *new_lazy = (int*)realloc(st->lazy, new_tree_size * sizeof(int));
+        if (new_lazy == NULL) {
+            return SEGTREE_ERROR_MEMORY_ALLOCATION;
+        }
+        st->lazy = new_lazy;
+        shift_levels(st->lazy, st->capacity, shift, st->identity);
+    }
+
+    shift_levels(st->tree, st->capacity, shift, st->identity);
+
+    for (int node = (1 << shift) / 2; node >= 1; node /= 2) {
+        st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
+    }
+
+    st->capacity = new_capacity;
+    st->tree_size = new_tree_size;
+
+    if (st->cache != NULL) {
+        segtree_cache_invalidate_all(st);
+    }
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_append(segment_tree_t *st, int value) {
+    return segtree_append_many(st, &value, 1);
+}
+
+segtree_error_t segtree_append_many(segment_tree_t *st, int *values, int count) {
+    if (st == NULL || values == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (count <= 0 || count > SEGTREE_MAX_SIZE - st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->frequency_mode && !all_nonnegative(values, count)) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    segtree_error_t error = grow_capacity(st, st->size + count);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    if (st->wal != NULL) {
+        error = segtree_wal_log(st, SEGTREE_WAL_APPEND, NULL, NULL, values, count);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int first = st->size;
+    st->size += count;
+
+    /* Tags only ever sit on nodes inside [0, size), so the ancestors of the
+     * new leaves carry none and a plain combine is exact for lazy trees too. */
+    int lo = st->capacity + first;
+    int hi = lo + count - 1;
+
+    memcpy(st->tree + lo, values, count * sizeof(int));
+
+    for (lo /= 2, hi /= 2; lo >= 1; lo /= 2, hi /= 2) {
+        for (int node = lo; node <= hi; node++) {
+            st->tree[node] = st->combine(st->tree[2 * node], st->tree[2 * node + 1]);
+        }
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count++;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+    segtree_metrics_record_batch(SEGTREE_PERF_UPDATE_POINT, end_time - start_time, count);
 
     return SEGTREE_OK;
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "../include/segtree_2d.h"
+
+static int next_power_of_two(int n) {
+    int size = 1;
+    while (size < n) {
+        size *= 2;
+    }
+    return size;
+}
+
+static inline int* row_nodes(segtree_2d_t *st, int row_node) {
+    return st->tree + (size_t)row_node * st->stride;
+}
+
+static void build_row_columns(segtree_2d_t *st, int *row) {
+    for (int node = st->col_capacity - 1; node >= 1; node--) {
+        row[node] = st->combine(row[2 * node], row[2 * node + 1]);
+    }
+}
+
+segtree_2d_t* segtree_2d_create(int *grid, int rows, int cols, segtree_operation_t op) {
+    if (grid == NULL || rows <= 0 || cols <= 0 || rows > SEGTREE_MAX_SIZE / cols) {
+        return NULL;
+    }
+
+    if (op != SEGTREE_SUM && op != SEGTREE_MIN && op != SEGTREE_MAX) {
+        return NULL;
+    }
+
+    segtree_2d_t *st = (segtree_2d_t*)malloc(sizeof(segtree_2d_t));
+    if (st == NULL) {
+        return NULL;
+    }
+
+    st->rows = rows;
+    st->cols = cols;
+    st->row_capacity = next_power_of_two(rows);
+    st->col_capacity = next_power_of_two(cols);
+    st->stride = 2 * st->col_capacity;
+    st->op_type = op;
+
+    switch (op) {
+        case SEGTREE_MIN:
+            st->combine = combine_min;
+            st->identity = SEGTREE_INF;
+            break;
+        case SEGTREE_MAX:
+            st->combine = combine_max;
+            st->identity = SEGTREE_NEG_INF;
+            break;
+        default:
+            st->combine = combine_sum;
+            st->identity = 0;
+            break;
+    }
+
+    /* One (2R x 2C) block: row-tree node r owns the column tree at row r. */
+    size_t total = (size_t)2 * st->row_capacity * st->stride;
+    st->tree = (int*)malloc(total * sizeof(int));
+    if (st->tree == NULL) {
+        free(st);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < total; i++) {
+        st->tree[i] = st->identity;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        int *row = row_nodes(st, st->row_capacity + r);
+        memcpy(row + st->col_capacity, grid + (size_t)r * cols, cols * sizeof(int));
+        build_row_columns(st, row);
+    }
+
+    for (int node = st->row_capacity - 1; node >= 1; node--) {
+        int *row = row_nodes(st, node);
+        int *upper = row_nodes(st, 2 * node);
+        int *lower = row_nodes(st, 2 * node + 1);
+        for (int c = 1; c < st->stride; c++) {
+            row[c] = st->combine(upper[c], lower[c]);
+        }
+    }
+
+    memset(&st->stats, 0, sizeof(segtree_stats_t));
+
+    return st;
+}
+
+void segtree_2d_destroy(segtree_2d_t *st) {
+    if (st == NULL) {
+        return;
+    }
+
+    free(st->tree);
+    free(st);
+}
+
+static int query_row(segtree_2d_t *st, int row_node, int col1, int col2) {
+    int *row = row_nodes(st, row_node);
+    int result = st->identity;
+
+    for (int l = col1 + st->col_capacity, r = col2 + st->col_capacity + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            result = st->combine(result, row[l++]);
+        }
+        if (r & 1) {
+            result = st->combine(result, row[--r]);
+        }
+    }
+
+    return result;
+}
+
+segtree_error_t segtree_2d_query(segtree_2d_t *st, int row1, int col1, int row2, int col2, int *result) {
+    if (st == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (row1 < 0 || col1 < 0 || row2 >= st->rows || col2 >= st->cols || row1 > row2 || col1 > col2) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int value = st->identity;
+    for (int l = row1 + st->row_capacity, r = row2 + st->row_capacity + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            value = st->combine(value, query_row(st, l++, col1, col2));
+        }
+        if (r & 1) {
+            value = st->combine(value, query_row(st, --r, col1, col2));
+        }
+    }
+
+    *result = value;
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count++;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_2d_update_point(segtree_2d_t *st, int row, int col, int value) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (row < 0 || col < 0 || row >= st->rows || col >= st->cols) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int row_node = row + st->row_capacity;
+    int col_leaf = col + st->col_capacity;
+
+    int *leaf_row = row_nodes(st, row_node);
+    leaf_row[col_leaf] = value;
+    for (int c = col_leaf / 2; c >= 1; c /= 2) {
+        leaf_row[c] = st->combine(leaf_row[2 * c], leaf_row[2 * c + 1]);
+    }
+
+    for (row_node /= 2; row_node >= 1; row_node /= 2) {
+        int *node_row = row_nodes(st, row_node);
+        int *upper = row_nodes(st, 2 * row_node);
+        int *lower = row_nodes(st, 2 * row_node + 1);
+        for (int c = col_leaf; c >= 1; c /= 2) {
+            node_row[c] = st->combine(upper[c], lower[c]);
+        }
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count++;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
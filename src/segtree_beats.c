@@ -0,0 +1,361 @@
+#include "../include/segtree_beats.h"
+
+static void set_leaf(segtree_beats_node_t *node, int value) {
+    node->sum = value;
+    node->max1 = value;
+    node->max2 = SEGTREE_BEATS_NO_MAX2;
+    node->max_count = 1;
+    node->min1 = value;
+    node->min2 = SEGTREE_BEATS_NO_MIN2;
+    node->min_count = 1;
+    node->add = 0;
+}
+
+static void pull(segtree_beats_t *bt, int node) {
+    segtree_beats_node_t *cur = &bt->nodes[node];
+    const segtree_beats_node_t *l = &bt->nodes[2 * node];
+    const segtree_beats_node_t *r = &bt->nodes[2 * node + 1];
+
+    cur->sum = l->sum + r->sum;
+
+    if (l->max1 == r->max1) {
+        cur->max1 = l->max1;
+        cur->max_count = l->max_count + r->max_count;
+        cur->max2 = l->max2 > r->max2 ? l->max2 : r->max2;
+    } else if (l->max1 > r->max1) {
+        cur->max1 = l->max1;
+        cur->max_count = l->max_count;
+        cur->max2 = l->max2 > r->max1 ? l->max2 : r->max1;
+    } else {
+        cur->max1 = r->max1;
+        cur->max_count = r->max_count;
+        cur->max2 = l->max1 > r->max2 ? l->max1 : r->max2;
+    }
+
+    if (l->min1 == r->min1) {
+        cur->min1 = l->min1;
+        cur->min_count = l->min_count + r->min_count;
+        cur->min2 = l->min2 < r->min2 ? l->min2 : r->min2;
+    } else if (l->min1 < r->min1) {
+        cur->min1 = l->min1;
+        cur->min_count = l->min_count;
+        cur->min2 = l->min2 < r->min1 ? l->min2 : r->min1;
+    } else {
+        cur->min1 = r->min1;
+        cur->min_count = r->min_count;
+        cur->min2 = l->min1 < r->min2 ? l->min1 : r->min2;
+    }
+}
+
+static void apply_add(segtree_beats_node_t *node, int len, int value) {
+    node->sum += (long long)value * len;
+    node->max1 += value;
+    node->min1 += value;
+    if (node->max2 != SEGTREE_BEATS_NO_MAX2) {
+        node->max2 += value;
+    }
+    if (node->min2 != SEGTREE_BEATS_NO_MIN2) {
+        node->min2 += value;
+    }
+    node->add += value;
+}
+
+/* Lowers the maximum to value; only valid while max2 < value < max1. */
+static void apply_chmin(segtree_beats_node_t *node, int value) {
+    node->sum -= ((long long)node->max1 - value) * node->max_count;
+    if (node->min1 == node->max1) {
+        node->min1 = value;
+    } else if (node->min2 == node->max1) {
+        node->min2 = value;
+    }
+    node->max1 = value;
+}
+
+static void apply_chmax(segtree_beats_node_t *node, int value) {
+    node->sum += ((long long)value - node->min1) * node->min_count;
+    if (node->max1 == node->min1) {
+        node->max1 = value;
+    } else if (node->max2 == node->min1) {
+        node->max2 = value;
+    }
+    node->min1 = value;
+}
+
+static void push(segtree_beats_t *bt, int node, int start, int end) {
+    segtree_beats_node_t *cur = &bt->nodes[node];
+    int mid = start + (end - start) / 2;
+
+    for (int child = 2 * node; child <= 2 * node + 1; child++) {
+        segtree_beats_node_t *c = &bt->nodes[child];
+        int len = (child == 2 * node) ? mid - start + 1 : end - mid;
+
+        if (cur->add != 0) {
+            apply_add(c, len, cur->add);
+        }
+        if (c->max1 > cur->max1) {
+            apply_chmin(c, cur->max1);
+        }
+        if (c->min1 < cur->min1) {
+            apply_chmax(c, cur->min1);
+        }
+    }
+
+    cur->add = 0;
+}
+
+static void build(segtree_beats_t *bt, int *arr, int node, int start, int end) {
+    if (start == end) {
+        set_leaf(&bt->nodes[node], arr[start]);
+        return;
+    }
+
+    int mid = start + (end - start) / 2;
+    build(bt, arr, 2 * node, start, mid);
+    build(bt, arr, 2 * node + 1, mid + 1, end);
+    bt->nodes[node].add = 0;
+    pull(bt, node);
+}
+
+static void chmin_range(segtree_beats_t *bt, int node, int start, int end, int left, int right, int value) {
+    if (right < start || end < left || bt->nodes[node].max1 <= value) {
+        return;
+    }
+
+    /* A leaf has no second maximum, so it can always take the tag. */
+    if (left <= start && end <= right && (start == end || bt->nodes[node].max2 < value)) {
+        apply_chmin(&bt->nodes[node], value);
+        return;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    chmin_range(bt, 2 * node, start, mid, left, right, value);
+    chmin_range(bt, 2 * node + 1, mid + 1, end, left, right, value);
+    pull(bt, node);
+}
+
+static void chmax_range(segtree_beats_t *bt, int node, int start, int end, int left, int right, int value) {
+    if (right < start || end < left || bt->nodes[node].min1 >= value) {
+        return;
+    }
+
+    if (left <= start && end <= right && (start == end || bt->nodes[node].min2 > value)) {
+        apply_chmax(&bt->nodes[node], value);
+        return;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    chmax_range(bt, 2 * node, start, mid, left, right, value);
+    chmax_range(bt, 2 * node + 1, mid + 1, end, left, right, value);
+    pull(bt, node);
+}
+
+static void add_range(segtree_beats_t *bt, int node, int start, int end, int left, int right, int value) {
+    if (right < start || end < left) {
+        return;
+    }
+
+    if (left <= start && end <= right) {
+        apply_add(&bt->nodes[node], end - start + 1, value);
+        return;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    add_range(bt, 2 * node, start, mid, left, right, value);
+    add_range(bt, 2 * node + 1, mid + 1, end, left, right, value);
+    pull(bt, node);
+}
+
+static long long sum_range(segtree_beats_t *bt, int node, int start, int end, int left, int right) {
+    if (right < start || end < left) {
+        return 0;
+    }
+
+    if (left <= start && end <= right) {
+        return bt->nodes[node].sum;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    return sum_range(bt, 2 * node, start, mid, left, right) +
+           sum_range(bt, 2 * node + 1, mid + 1, end, left, right);
+}
+
+static int min_range(segtree_beats_t *bt, int node, int start, int end, int left, int right) {
+    if (right < start || end < left) {
+        return SEGTREE_INF;
+    }
+
+    if (left <= start && end <= right) {
+        return bt->nodes[node].min1;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    return combine_min(min_range(bt, 2 * node, start, mid, left, right),
+                       min_range(bt, 2 * node + 1, mid + 1, end, left, right));
+}
+
+static int max_range(segtree_beats_t *bt, int node, int start, int end, int left, int right) {
+    if (right < start || end < left) {
+        return SEGTREE_NEG_INF;
+    }
+
+    if (left <= start && end <= right) {
+        return bt->nodes[node].max1;
+    }
+
+    push(bt, node, start, end);
+    int mid = start + (end - start) / 2;
+    return combine_max(max_range(bt, 2 * node, start, mid, left, right),
+                       max_range(bt, 2 * node + 1, mid + 1, end, left, right));
+}
+
+segtree_beats_t* segtree_beats_create(int *arr, int n) {
+    if (arr == NULL || n <= 0 || n > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    segtree_beats_t *bt = (segtree_beats_t*)malloc(sizeof(segtree_beats_t));
+    if (bt == NULL) {
+        return NULL;
+    }
+
+    bt->size = n;
+    bt->tree_size = 4 * n;
+    bt->nodes = (segtree_beats_node_t*)malloc(bt->tree_size * sizeof(segtree_beats_node_t));
+    if (bt->nodes == NULL) {
+        free(bt);
+        return NULL;
+    }
+
+    build(bt, arr, 1, 0, n - 1);
+    memset(&bt->stats, 0, sizeof(segtree_stats_t));
+
+    return bt;
+}
+
+void segtree_beats_destroy(segtree_beats_t *bt) {
+    if (bt == NULL) {
+        return;
+    }
+
+    free(bt->nodes);
+    free(bt);
+}
+
+static segtree_error_t check_range(segtree_beats_t *bt, int left, int right) {
+    if (bt == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= bt->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    return SEGTREE_OK;
+}
+
+static void record_update(segtree_beats_t *bt, unsigned long long start_time) {
+    unsigned long long end_time = segtree_clock_ns();
+    bt->stats.update_count++;
+    bt->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+}
+
+static void record_query(segtree_beats_t *bt, unsigned long long start_time) {
+    unsigned long long end_time = segtree_clock_ns();
+    bt->stats.query_count++;
+    bt->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+}
+
+segtree_error_t segtree_beats_chmin(segtree_beats_t *bt, int left, int right, int value) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    chmin_range(bt, 1, 0, bt->size - 1, left, right, value);
+    record_update(bt, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_beats_chmax(segtree_beats_t *bt, int left, int right, int value) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    chmax_range(bt, 1, 0, bt->size - 1, left, right, value);
+    record_update(bt, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_beats_add(segtree_beats_t *bt, int left, int right, int value) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    add_range(bt, 1, 0, bt->size - 1, left, right, value);
+    record_update(bt, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_beats_query_sum(segtree_beats_t *bt, int left, int right, long long *result) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    if (result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    *result = sum_range(bt, 1, 0, bt->size - 1, left, right);
+    record_query(bt, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_beats_query_min(segtree_beats_t *bt, int left, int right, int *result) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    if (result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    *result = min_range(bt, 1, 0, bt->size - 1, left, right);
+    record_query(bt, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_beats_query_max(segtree_beats_t *bt, int left, int right, int *result) {
+    segtree_error_t err = check_range(bt, left, right);
+    if (err != SEGTREE_OK) {
+        return err;
+    }
+
+    if (result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    *result = max_range(bt, 1, 0, bt->size - 1, left, right);
+    record_query(bt, start_time);
+
+    return SEGTREE_OK;
+}
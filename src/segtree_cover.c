@@ -0,0 +1,235 @@
+#include "../include/segtree_cover.h"
+
+static inline long long coord(const segtree_cover_t *ct, int i) {
+    return ct->coords != NULL ? (long long)ct->coords[i] : (long long)i;
+}
+
+static void pull(segtree_cover_t *ct, int node, int lo, int hi) {
+    if (ct->count[node] > 0) {
+        ct->covered[node] = coord(ct, hi + 1) - coord(ct, lo);
+    } else if (lo == hi) {
+        ct->covered[node] = 0;
+    } else {
+        ct->covered[node] = ct->covered[2 * node] + ct->covered[2 * node + 1];
+    }
+}
+
+/* Counts stay on the canonical nodes of each interval and are never pushed down. */
+static void update(segtree_cover_t *ct, int node, int lo, int hi, int a, int b, int delta) {
+    if (b < lo || hi < a) {
+        return;
+    }
+
+    if (a <= lo && hi <= b) {
+        ct->count[node] += delta;
+        pull(ct, node, lo, hi);
+        return;
+    }
+
+    int mid = lo + (hi - lo) / 2;
+    update(ct, 2 * node, lo, mid, a, b, delta);
+    update(ct, 2 * node + 1, mid + 1, hi, a, b, delta);
+    pull(ct, node, lo, hi);
+}
+
+/* A removal must find a count on every canonical node it would decrement. */
+static bool removable(const segtree_cover_t *ct, int node, int lo, int hi, int a, int b) {
+    if (b < lo || hi < a) {
+        return true;
+    }
+
+    if (a <= lo && hi <= b) {
+        return ct->count[node] > 0;
+    }
+
+    int mid = lo + (hi - lo) / 2;
+    return removable(ct, 2 * node, lo, mid, a, b) && removable(ct, 2 * node + 1, mid + 1, hi, a, b);
+}
+
+static long long covered_in(const segtree_cover_t *ct, int node, int lo, int hi, long long begin, long long end) {
+    long long node_begin = coord(ct, lo);
+    long long node_end = coord(ct, hi + 1);
+
+    if (end <= node_begin || node_end <= begin) {
+        return 0;
+    }
+
+    if (ct->count[node] > 0) {
+        long long from = begin > node_begin ? begin : node_begin;
+        long long to = end < node_end ? end : node_end;
+        return to - from;
+    }
+
+    if ((begin <= node_begin && node_end <= end) || lo == hi) {
+        return ct->covered[node];
+    }
+
+    int mid = lo + (hi - lo) / 2;
+    return covered_in(ct, 2 * node, lo, mid, begin, end) +
+           covered_in(ct, 2 * node + 1, mid + 1, hi, begin, end);
+}
+
+static segtree_cover_t* cover_alloc(int segments) {
+    segtree_cover_t *ct = (segtree_cover_t*)malloc(sizeof(segtree_cover_t));
+    if (ct == NULL) {
+        return NULL;
+    }
+
+    ct->segments = segments;
+    ct->tree_size = 4 * segments;
+    ct->count = (int*)calloc(ct->tree_size, sizeof(int));
+    ct->covered = (long long*)calloc(ct->tree_size, sizeof(long long));
+    ct->coords = NULL;
+
+    if (ct->count == NULL || ct->covered == NULL) {
+        segtree_cover_destroy(ct);
+        return NULL;
+    }
+
+    memset(&ct->stats, 0, sizeof(segtree_stats_t));
+    return ct;
+}
+
+segtree_cover_t* segtree_cover_create(int n) {
+    if (n <= 0 || n > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    return cover_alloc(n);
+}
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+segtree_cover_t* segtree_cover_create_compressed(const int *coords, int count) {
+    if (coords == NULL || count < 2 || count > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    int *sorted = (int*)malloc(count * sizeof(int));
+    if (sorted == NULL) {
+        return NULL;
+    }
+    memcpy(sorted, coords, count * sizeof(int));
+    qsort(sorted, count, sizeof(int), compare_ints);
+
+    int unique = 1;
+    for (int i = 1; i < count; i++) {
+        if (sorted[i] != sorted[unique - 1]) {
+            sorted[unique++] = sorted[i];
+        }
+    }
+
+    if (unique < 2) {
+        free(sorted);
+        return NULL;
+    }
+
+    segtree_cover_t *ct = cover_alloc(unique - 1);
+    if (ct == NULL) {
+        free(sorted);
+        return NULL;
+    }
+
+    ct->coords = sorted;
+    return ct;
+}
+
+void segtree_cover_destroy(segtree_cover_t *ct) {
+    if (ct == NULL) {
+        return;
+    }
+
+    free(ct->count);
+    free(ct->covered);
+    free(ct->coords);
+    free(ct);
+}
+
+/* Position of x among the coordinates, or -1 if it is not one of them. */
+static int coord_index(const segtree_cover_t *ct, int x) {
+    if (ct->coords == NULL) {
+        return (x >= 0 && x <= ct->segments) ? x : -1;
+    }
+
+    int lo = 0;
+    int hi = ct->segments;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ct->coords[mid] < x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return (ct->coords[lo] == x) ? lo : -1;
+}
+
+static void record_update(segtree_cover_t *ct, unsigned long long start_time) {
+    unsigned long long end_time = segtree_clock_ns();
+    ct->stats.update_count++;
+    ct->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+}
+
+static void record_query(segtree_cover_t *ct, unsigned long long start_time) {
+    unsigned long long end_time = segtree_clock_ns();
+    ct->stats.query_count++;
+    ct->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+}
+
+static segtree_error_t change_cover(segtree_cover_t *ct, int begin, int end, int delta) {
+    if (ct == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    int first = coord_index(ct, begin);
+    int last = coord_index(ct, end);
+    if (first < 0 || last < 0 || first >= last) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    /* Segments first .. last - 1 make up [begin, end). */
+    if (delta < 0 && !removable(ct, 1, 0, ct->segments - 1, first, last - 1)) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+    update(ct, 1, 0, ct->segments - 1, first, last - 1, delta);
+    record_update(ct, start_time);
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_cover_add(segtree_cover_t *ct, int begin, int end) {
+    return change_cover(ct, begin, end, 1);
+}
+
+segtree_error_t segtree_cover_remove(segtree_cover_t *ct, int begin, int end) {
+    return change_cover(ct, begin, end, -1);
+}
+
+long long segtree_cover_total(const segtree_cover_t *ct) {
+    return ct != NULL ? ct->covered[1] : 0;
+}
+
+segtree_error_t segtree_cover_query(segtree_cover_t *ct, int begin, int end, long long *length) {
+    if (ct == NULL || length == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (begin > end) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    /* Any bounds work: elementary segments are covered all or nothing. */
+    *length = covered_in(ct, 1, 0, ct->segments - 1, begin, end);
+    record_query(ct, start_time);
+
+    return SEGTREE_OK;
+}
@@ -0,0 +1,708 @@
+#define _XOPEN_SOURCE 700
+#define _FILE_OFFSET_BITS 64
+
+#include "../include/segtree_disk.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#define DISK_MAGIC "SEGTDSK1"
+
+typedef struct {
+    char magic[8];
+    long long size;
+    int depth;
+    int resident_levels;
+    int op_type;
+    int page_size;
+} disk_header_t;
+
+struct segtree_disk_cache {
+    int frames;
+    int used;
+    long long *page;
+    bool *dirty;
+    int *prev;
+    int *next;
+    int head;
+    int tail;
+    int *bucket;
+    int *chain;
+    int bucket_mask;
+    long long *data;
+};
+
+static inline long long combine_disk(const segtree_disk_t *dt, long long a, long long b) {
+    switch (dt->op_type) {
+        case SEGTREE_MIN:
+            return a < b ? a : b;
+        case SEGTREE_MAX:
+            return a > b ? a : b;
+        default:
+            return a + b;
+    }
+}
+
+static inline int node_depth(long long node) {
+    return 63 - __builtin_clzll((unsigned long long)node);
+}
+
+static long long resident_bytes(const segtree_disk_t *dt) {
+    long long bytes = (1LL << dt->resident_levels) * (long long)sizeof(long long);
+    return (bytes + SEGTREE_DISK_PAGE_SIZE - 1) / SEGTREE_DISK_PAGE_SIZE * SEGTREE_DISK_PAGE_SIZE;
+}
+
+static off_t page_offset(const segtree_disk_t *dt, long long page) {
+    return (off_t)SEGTREE_DISK_PAGE_SIZE + (off_t)resident_bytes(dt) + (off_t)page * SEGTREE_DISK_PAGE_SIZE;
+}
+
+/*
+ * Keeps exactly resident_levels in memory. The levels below are cut into
+ * bands from the bottom up, so only the top band may be shorter than
+ * SEGTREE_DISK_BAND_LEVELS. Fails if that takes more than the maximum bands.
+ */
+static bool setup_layout(segtree_disk_t *dt, int resident_levels) {
+    int levels = dt->depth + 1;
+
+    if (resident_levels < 1) {
+        resident_levels = 1;
+    }
+    if (resident_levels > levels) {
+        resident_levels = levels;
+    }
+
+    dt->resident_levels = resident_levels;
+    dt->band_count = (levels - resident_levels + SEGTREE_DISK_BAND_LEVELS - 1) / SEGTREE_DISK_BAND_LEVELS;
+    if (dt->band_count > SEGTREE_DISK_MAX_BANDS) {
+        return false;
+    }
+
+    dt->page_count = 0;
+    dt->band_top[dt->band_count] = levels;
+    for (int b = dt->band_count - 1; b >= 0; b--) {
+        int top = dt->band_top[b + 1] - SEGTREE_DISK_BAND_LEVELS;
+        dt->band_top[b] = top > resident_levels ? top : resident_levels;
+    }
+    for (int b = 0; b < dt->band_count; b++) {
+        dt->band_offset[b] = dt->page_count;
+        dt->page_count += 1LL << (dt->band_top[b] - 1);
+    }
+
+    return true;
+}
+
+/* Page and slot of a node below the resident levels; slots 0 and 1 are unused. */
+static inline void locate(const segtree_disk_t *dt, long long node, int depth, long long *page, int *slot) {
+    int band = dt->band_count - 1;
+    while (depth < dt->band_top[band]) {
+        band--;
+    }
+
+    int top = dt->band_top[band];
+    int shift = depth - top + 1;
+    long long parent = node >> shift;
+
+    *page = dt->band_offset[band] + (parent - (1LL << (top - 1)));
+    *slot = (int)((1LL << shift) | (node & ((1LL << shift) - 1)));
+}
+
+static bool write_all(int fd, const void *buffer, size_t bytes, off_t offset) {
+    const char *p = (const char*)buffer;
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, p, bytes, offset);
+        if (written <= 0) {
+            return false;
+        }
+        p += written;
+        bytes -= (size_t)written;
+        offset += written;
+    }
+    return true;
+}
+
+/* Reads up to bytes; anything past end of file is zero-filled. */
+static bool read_all(int fd, void *buffer, size_t bytes, off_t offset) {
+    char *p = (char*)buffer;
+    while (bytes > 0) {
+        ssize_t got = pread(fd, p, bytes, offset);
+        if (got < 0) {
+            return false;
+        }
+        if (got == 0) {
+            memset(p, 0, bytes);
+            return true;
+        }
+        p += got;
+        bytes -= (size_t)got;
+        offset += got;
+    }
+    return true;
+}
+
+static struct segtree_disk_cache* cache_create(int frames) {
+    struct segtree_disk_cache *cache = (struct segtree_disk_cache*)calloc(1, sizeof(struct segtree_disk_cache));
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    int buckets = 1;
+    while (buckets < 2 * frames) {
+        buckets *= 2;
+    }
+
+    cache->frames = frames;
+    cache->bucket_mask = buckets - 1;
+    cache->head = -1;
+    cache->tail = -1;
+    cache->page = (long long*)malloc(frames * sizeof(long long));
+    cache->dirty = (bool*)calloc(frames, sizeof(bool));
+    cache->prev = (int*)malloc(frames * sizeof(int));
+    cache->next = (int*)malloc(frames * sizeof(int));
+    cache->chain = (int*)malloc(frames * sizeof(int));
+    cache->bucket = (int*)malloc(buckets * sizeof(int));
+    cache->data = (long long*)malloc((size_t)frames * SEGTREE_DISK_PAGE_SIZE);
+
+    if (cache->page == NULL || cache->dirty == NULL || cache->prev == NULL || cache->next == NULL ||
+        cache->chain == NULL || cache->bucket == NULL || cache->data == NULL) {
+        free(cache->page);
+        free(cache->dirty);
+        free(cache->prev);
+        free(cache->next);
+        free(cache->chain);
+        free(cache->bucket);
+        free(cache->data);
+        free(cache);
+        return NULL;
+    }
+
+    for (int i = 0; i < buckets; i++) {
+        cache->bucket[i] = -1;
+    }
+
+    return cache;
+}
+
+static void cache_free(struct segtree_disk_cache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    free(cache->page);
+    free(cache->dirty);
+    free(cache->prev);
+    free(cache->next);
+    free(cache->chain);
+    free(cache->bucket);
+    free(cache->data);
+    free(cache);
+}
+
+static inline int page_bucket(const struct segtree_disk_cache *cache, long long page) {
+    unsigned long long h = (unsigned long long)page * 0x9e3779b97f4a7c15ULL;
+    return (int)(h >> 32) & cache->bucket_mask;
+}
+
+static void lru_unlink(struct segtree_disk_cache *cache, int frame) {
+    if (cache->prev[frame] >= 0) {
+        cache->next[cache->prev[frame]] = cache->next[frame];
+    } else {
+        cache->head = cache->next[frame];
+    }
+
+    if (cache->next[frame] >= 0) {
+        cache->prev[cache->next[frame]] = cache->prev[frame];
+    } else {
+        cache->tail = cache->prev[frame];
+    }
+}
+
+static void lru_push_front(struct segtree_disk_cache *cache, int frame) {
+    cache->prev[frame] = -1;
+    cache->next[frame] = cache->head;
+    if (cache->head >= 0) {
+        cache->prev[cache->head] = frame;
+    }
+    cache->head = frame;
+    if (cache->tail < 0) {
+        cache->tail = frame;
+    }
+}
+
+static void hash_remove(struct segtree_disk_cache *cache, int frame) {
+    int *link = &cache->bucket[page_bucket(cache, cache->page[frame])];
+    while (*link != frame) {
+        link = &cache->chain[*link];
+    }
+    *link = cache->chain[frame];
+}
+
+static inline long long* frame_data(struct segtree_disk_cache *cache, int frame) {
+    return cache->data + (size_t)frame * SEGTREE_DISK_PAGE_NODES;
+}
+
+static bool write_frame(segtree_disk_t *dt, int frame) {
+    struct segtree_disk_cache *cache = dt->cache;
+
+    if (!write_all(dt->fd, frame_data(cache, frame), SEGTREE_DISK_PAGE_SIZE, page_offset(dt, cache->page[frame]))) {
+        return false;
+    }
+
+    cache->dirty[frame] = false;
+    dt->io.page_writes++;
+    dt->io.bytes_written += SEGTREE_DISK_PAGE_SIZE;
+    return true;
+}
+
+/* Returns the frame holding page, reading it unless fresh; -1 on I/O failure. */
+static int cache_fetch(segtree_disk_t *dt, long long page, bool fresh) {
+    struct segtree_disk_cache *cache = dt->cache;
+    int bucket = page_bucket(cache, page);
+
+    for (int frame = cache->bucket[bucket]; frame >= 0; frame = cache->chain[frame]) {
+        if (cache->page[frame] == page) {
+            if (cache->head != frame) {
+                lru_unlink(cache, frame);
+                lru_push_front(cache, frame);
+            }
+            dt->io.cache_hits++;
+            return frame;
+        }
+    }
+
+    dt->io.cache_misses++;
+
+    int frame;
+    if (cache->used < cache->frames) {
+        frame = cache->used++;
+    } else {
+        frame = cache->tail;
+        if (cache->dirty[frame] && !write_frame(dt, frame)) {
+            return -1;
+        }
+        if (cache->page[frame] >= 0) {
+            hash_remove(cache, frame);
+        }
+        lru_unlink(cache, frame);
+        dt->io.evictions++;
+    }
+
+    long long *data = frame_data(cache, frame);
+    if (fresh) {
+        for (int i = 0; i < SEGTREE_DISK_PAGE_NODES; i++) {
+            data[i] = dt->identity;
+        }
+        cache->dirty[frame] = true;
+    } else {
+        if (!read_all(dt->fd, data, SEGTREE_DISK_PAGE_SIZE, page_offset(dt, page))) {
+            cache->page[frame] = -1;
+            cache->dirty[frame] = false;
+            lru_push_front(cache, frame);
+            return -1;
+        }
+        cache->dirty[frame] = false;
+        dt->io.page_reads++;
+        dt->io.bytes_read += SEGTREE_DISK_PAGE_SIZE;
+    }
+
+    cache->page[frame] = page;
+    cache->chain[frame] = cache->bucket[bucket];
+    cache->bucket[bucket] = frame;
+    lru_push_front(cache, frame);
+
+    return frame;
+}
+
+static bool node_get(segtree_disk_t *dt, long long node, long long *value) {
+    int depth = node_depth(node);
+    if (depth < dt->resident_levels) {
+        *value = dt->resident[node];
+        return true;
+    }
+
+    long long page;
+    int slot;
+    locate(dt, node, depth, &page, &slot);
+
+    int frame = cache_fetch(dt, page, false);
+    if (frame < 0) {
+        return false;
+    }
+
+    *value = frame_data(dt->cache, frame)[slot];
+    return true;
+}
+
+static bool node_set(segtree_disk_t *dt, long long node, long long value) {
+    int depth = node_depth(node);
+    if (depth < dt->resident_levels) {
+        dt->resident[node] = value;
+        return true;
+    }
+
+    long long page;
+    int slot;
+    locate(dt, node, depth, &page, &slot);
+
+    int frame = cache_fetch(dt, page, false);
+    if (frame < 0) {
+        return false;
+    }
+
+    frame_data(dt->cache, frame)[slot] = value;
+    dt->cache->dirty[frame] = true;
+    return true;
+}
+
+static bool pull_node(segtree_disk_t *dt, long long node) {
+    long long left, right;
+    if (!node_get(dt, 2 * node, &left) || !node_get(dt, 2 * node + 1, &right)) {
+        return false;
+    }
+    return node_set(dt, node, combine_disk(dt, left, right));
+}
+
+#define LEAF_CHUNK (1 << SEGTREE_DISK_BAND_LEVELS)
+
+/* Pulls leaves from the reader one leaf page at a time. */
+typedef struct {
+    segtree_disk_reader_t next;
+    void *ctx;
+    int buf[LEAF_CHUNK];
+    int len;
+    int pos;
+    long long consumed;
+} leaf_stream_t;
+
+static bool next_leaf(const segtree_disk_t *dt, leaf_stream_t *in, long long *value) {
+    if (in->consumed >= dt->size) {
+        *value = dt->identity;
+        return true;
+    }
+
+    if (in->pos == in->len) {
+        long long left = dt->size - in->consumed;
+        int want = left < LEAF_CHUNK ? (int)left : LEAF_CHUNK;
+        int got = in->next(in->ctx, in->buf, (size_t)want);
+        if (got <= 0 || got > want) {
+            return false;
+        }
+        in->len = got;
+        in->pos = 0;
+    }
+
+    *value = in->buf[in->pos++];
+    in->consumed++;
+    return true;
+}
+
+/* Builds one page bottom-up; its lowest level reads the band below (or the input). */
+static bool build_page(segtree_disk_t *dt, leaf_stream_t *in, int band, long long page) {
+    int top = dt->band_top[band];
+    long long parent = (page - dt->band_offset[band]) + (1LL << (top - 1));
+
+    if (cache_fetch(dt, page, true) < 0) {
+        return false;
+    }
+
+    for (int depth = dt->band_top[band + 1] - 1; depth >= top; depth--) {
+        int shift = depth - top + 1;
+        long long first = parent << shift;
+        long long last = (parent + 1) << shift;
+
+        for (long long node = first; node < last; node++) {
+            long long leaf;
+            bool ok = (depth == dt->depth) ? next_leaf(dt, in, &leaf) && node_set(dt, node, leaf)
+                                           : pull_node(dt, node);
+            if (!ok) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static segtree_disk_t* disk_alloc(int cache_pages) {
+    segtree_disk_t *dt = (segtree_disk_t*)calloc(1, sizeof(segtree_disk_t));
+    if (dt == NULL) {
+        return NULL;
+    }
+
+    dt->fd = -1;
+    dt->cache = cache_create(cache_pages < 2 ? 2 : cache_pages);
+    if (dt->cache == NULL) {
+        free(dt);
+        return NULL;
+    }
+
+    return dt;
+}
+
+static void disk_free(segtree_disk_t *dt) {
+    if (dt->fd >= 0) {
+        close(dt->fd);
+    }
+    cache_free(dt->cache);
+    free(dt->resident);
+    free(dt);
+}
+
+static void setup_identity(segtree_disk_t *dt) {
+    switch (dt->op_type) {
+        case SEGTREE_MIN:
+            dt->identity = SEGTREE_INF;
+            break;
+        case SEGTREE_MAX:
+            dt->identity = SEGTREE_NEG_INF;
+            break;
+        default:
+            dt->identity = 0;
+            break;
+    }
+}
+
+segtree_disk_t* segtree_disk_create(const char *path, segtree_disk_reader_t next, void *ctx, long long n,
+                                    segtree_operation_t op, int resident_levels, int cache_pages) {
+    if (path == NULL || next == NULL || n <= 0 || n > SEGTREE_DISK_MAX_SIZE) {
+        return NULL;
+    }
+
+    if (op != SEGTREE_SUM && op != SEGTREE_MIN && op != SEGTREE_MAX) {
+        return NULL;
+    }
+
+    segtree_disk_t *dt = disk_alloc(cache_pages);
+    if (dt == NULL) {
+        return NULL;
+    }
+
+    dt->size = n;
+    dt->op_type = op;
+    setup_identity(dt);
+
+    dt->capacity = 1;
+    dt->depth = 0;
+    while (dt->capacity < n) {
+        dt->capacity *= 2;
+        dt->depth++;
+    }
+    if (!setup_layout(dt, resident_levels)) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    dt->resident = (long long*)malloc((1LL << dt->resident_levels) * sizeof(long long));
+    dt->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (dt->resident == NULL || dt->fd < 0 || ftruncate(dt->fd, page_offset(dt, dt->page_count)) != 0) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    leaf_stream_t *in = (leaf_stream_t*)calloc(1, sizeof(leaf_stream_t));
+    if (in == NULL) {
+        disk_free(dt);
+        return NULL;
+    }
+    in->next = next;
+    in->ctx = ctx;
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    /* Pages of the lowest band are built left to right, so leaves arrive in index order. */
+    bool ok = true;
+    for (int band = dt->band_count - 1; band >= 0 && ok; band--) {
+        long long end = (band + 1 < dt->band_count) ? dt->band_offset[band + 1] : dt->page_count;
+        for (long long page = dt->band_offset[band]; page < end && ok; page++) {
+            ok = build_page(dt, in, band, page);
+        }
+    }
+
+    long long internal = (1LL << dt->resident_levels);
+    if (dt->band_count == 0) {
+        internal = dt->capacity;
+        for (long long node = dt->capacity; node < 2 * dt->capacity && ok; node++) {
+            long long leaf;
+            ok = next_leaf(dt, in, &leaf) && node_set(dt, node, leaf);
+        }
+    }
+
+    for (long long node = internal - 1; node >= 1 && ok; node--) {
+        ok = pull_node(dt, node);
+    }
+
+    ok = ok && in->consumed == n;
+    free(in);
+
+    if (!ok || segtree_disk_flush(dt) != SEGTREE_OK) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    dt->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+
+    return dt;
+}
+
+segtree_disk_t* segtree_disk_open(const char *path, int cache_pages) {
+    if (path == NULL) {
+        return NULL;
+    }
+
+    segtree_disk_t *dt = disk_alloc(cache_pages);
+    if (dt == NULL) {
+        return NULL;
+    }
+
+    disk_header_t header;
+    dt->fd = open(path, O_RDWR);
+    if (dt->fd < 0 || !read_all(dt->fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, DISK_MAGIC, sizeof(header.magic)) != 0 ||
+        header.page_size != SEGTREE_DISK_PAGE_SIZE || header.size <= 0 ||
+        header.depth < 0 || header.depth > 40 || header.resident_levels < 1 ||
+        header.resident_levels > header.depth + 1 ||
+        header.op_type < SEGTREE_SUM || header.op_type >= SEGTREE_CUSTOM) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    dt->size = header.size;
+    dt->depth = header.depth;
+    dt->capacity = 1LL << header.depth;
+    dt->op_type = (segtree_operation_t)header.op_type;
+    setup_identity(dt);
+    if (!setup_layout(dt, header.resident_levels)) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    dt->resident = (long long*)malloc((1LL << dt->resident_levels) * sizeof(long long));
+    if (dt->resident == NULL ||
+        !read_all(dt->fd, dt->resident, (1LL << dt->resident_levels) * sizeof(long long), SEGTREE_DISK_PAGE_SIZE)) {
+        disk_free(dt);
+        return NULL;
+    }
+
+    return dt;
+}
+
+segtree_error_t segtree_disk_flush(segtree_disk_t *dt) {
+    if (dt == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    struct segtree_disk_cache *cache = dt->cache;
+    for (int frame = 0; frame < cache->used; frame++) {
+        if (cache->dirty[frame] && !write_frame(dt, frame)) {
+            return SEGTREE_ERROR_IO;
+        }
+    }
+
+    disk_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISK_MAGIC, sizeof(header.magic));
+    header.size = dt->size;
+    header.depth = dt->depth;
+    header.resident_levels = dt->resident_levels;
+    header.op_type = (int)dt->op_type;
+    header.page_size = SEGTREE_DISK_PAGE_SIZE;
+
+    size_t bytes = (size_t)(1LL << dt->resident_levels) * sizeof(long long);
+    if (!write_all(dt->fd, dt->resident, bytes, SEGTREE_DISK_PAGE_SIZE) ||
+        !write_all(dt->fd, &header, sizeof(header), 0)) {
+        return SEGTREE_ERROR_IO;
+    }
+
+    dt->io.bytes_written += bytes + sizeof(header);
+    return SEGTREE_OK;
+}
+
+void segtree_disk_destroy(segtree_disk_t *dt) {
+    if (dt == NULL) {
+        return;
+    }
+
+    segtree_disk_flush(dt);
+    disk_free(dt);
+}
+
+segtree_error_t segtree_disk_query(segtree_disk_t *dt, long long left, long long right, long long *result) {
+    if (dt == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= dt->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    long long value = dt->identity;
+    for (long long l = left + dt->capacity, r = right + dt->capacity + 1; l < r; l >>= 1, r >>= 1) {
+        long long node_value;
+        if (l & 1) {
+            if (!node_get(dt, l++, &node_value)) {
+                return SEGTREE_ERROR_IO;
+            }
+            value = combine_disk(dt, value, node_value);
+        }
+        if (r & 1) {
+            if (!node_get(dt, --r, &node_value)) {
+                return SEGTREE_ERROR_IO;
+            }
+            value = combine_disk(dt, value, node_value);
+        }
+    }
+
+    *result = value;
+
+    unsigned long long end_time = segtree_clock_ns();
+    dt->stats.query_count++;
+    dt->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_disk_update_point(segtree_disk_t *dt, long long index, int value) {
+    if (dt == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= dt->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    long long node = index + dt->capacity;
+    if (!node_set(dt, node, value)) {
+        return SEGTREE_ERROR_IO;
+    }
+
+    for (node >>= 1; node >= 1; node >>= 1) {
+        if (!pull_node(dt, node)) {
+            return SEGTREE_ERROR_IO;
+        }
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    dt->stats.update_count++;
+    dt->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_disk_io_t segtree_disk_get_io(segtree_disk_t *dt) {
+    segtree_disk_io_t io;
+    if (dt == NULL) {
+        memset(&io, 0, sizeof(io));
+        return io;
+    }
+    return dt->io;
+}
+
+void segtree_disk_reset_io(segtree_disk_t *dt) {
+    if (dt == NULL) {
+        return;
+    }
+    memset(&dt->io, 0, sizeof(dt->io));
+}
@@ -0,0 +1,162 @@
+#include "../include/segtree_generic.h"
+#include <stdint.h>
+
+static inline unsigned char* node_at(const segtree_generic_t *st, int node) {
+    return st->tree + (size_t)node * st->stride;
+}
+
+segtree_generic_t* segtree_generic_create(const void *arr, int n, size_t elem_size, size_t alignment,
+                                          segtree_generic_combine_t combine, void *ctx,
+                                          const void *identity) {
+    if (arr == NULL || combine == NULL || identity == NULL) {
+        return NULL;
+    }
+
+    if (n <= 0 || n > SEGTREE_MAX_SIZE || elem_size == 0) {
+        return NULL;
+    }
+
+    if (alignment == 0) {
+        alignment = 1;
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        return NULL;
+    }
+
+    segtree_generic_t *st = (segtree_generic_t*)malloc(sizeof(segtree_generic_t));
+    if (st == NULL) {
+        return NULL;
+    }
+
+    st->elem_size = elem_size;
+    st->alignment = alignment;
+    st->stride = (elem_size + alignment - 1) & ~(alignment - 1);
+    st->size = n;
+    st->capacity = 1;
+    while (st->capacity < n) {
+        st->capacity *= 2;
+    }
+    st->combine = combine;
+    st->ctx = ctx;
+
+    /* Node storage plus the identity and three scratch slots, aligned as one block. */
+    size_t slots = 2 * (size_t)st->capacity + 4;
+    st->block = (unsigned char*)malloc(slots * st->stride + alignment);
+    if (st->block == NULL) {
+        free(st);
+        return NULL;
+    }
+
+    uintptr_t base = ((uintptr_t)st->block + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    st->tree = (unsigned char*)base;
+    st->identity = node_at(st, 2 * st->capacity);
+    st->scratch = node_at(st, 2 * st->capacity + 1);
+
+    memcpy(st->identity, identity, elem_size);
+
+    const unsigned char *src = (const unsigned char*)arr;
+    for (int i = 0; i < st->capacity; i++) {
+        const void *value = (i < n) ? (const void*)(src + (size_t)i * elem_size) : (const void*)st->identity;
+        memcpy(node_at(st, st->capacity + i), value, elem_size);
+    }
+
+    for (int node = st->capacity - 1; node >= 1; node--) {
+        combine(ctx, node_at(st, 2 * node), node_at(st, 2 * node + 1), node_at(st, node));
+    }
+
+    memset(&st->stats, 0, sizeof(segtree_stats_t));
+
+    return st;
+}
+
+void segtree_generic_destroy(segtree_generic_t *st) {
+    if (st == NULL) {
+        return;
+    }
+
+    free(st->block);
+    free(st);
+}
+
+segtree_error_t segtree_generic_query(segtree_generic_t *st, int left, int right, void *result) {
+    if (st == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= st->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    /* Rotate three scratch slots so combine never writes into one of its inputs. */
+    unsigned char *left_value = st->scratch;
+    unsigned char *right_value = st->scratch + st->stride;
+    unsigned char *spare = st->scratch + 2 * st->stride;
+    unsigned char *swap;
+
+    memcpy(left_value, st->identity, st->elem_size);
+    memcpy(right_value, st->identity, st->elem_size);
+
+    for (int l = left + st->capacity, r = right + st->capacity + 1; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            st->combine(st->ctx, left_value, node_at(st, l++), spare);
+            swap = left_value;
+            left_value = spare;
+            spare = swap;
+        }
+        if (r & 1) {
+            st->combine(st->ctx, node_at(st, --r), right_value, spare);
+            swap = right_value;
+            right_value = spare;
+            spare = swap;
+        }
+    }
+
+    st->combine(st->ctx, left_value, right_value, spare);
+    memcpy(result, spare, st->elem_size);
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.query_count++;
+    st->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_generic_update_point(segtree_generic_t *st, int index, const void *value) {
+    if (st == NULL || value == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int node = index + st->capacity;
+    memcpy(node_at(st, node), value, st->elem_size);
+
+    for (node /= 2; node >= 1; node /= 2) {
+        st->combine(st->ctx, node_at(st, 2 * node), node_at(st, 2 * node + 1), node_at(st, node));
+    }
+
+    unsigned long long end_time = segtree_clock_ns();
+    st->stats.update_count++;
+    st->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_generic_get(segtree_generic_t *st, int index, void *value) {
+    if (st == NULL || value == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    memcpy(value, node_at(st, index + st->capacity), st->elem_size);
+    return SEGTREE_OK;
+}
@@ -0,0 +1,435 @@
+#include "../include/segtree_packed.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define SEGTREE_PACKED_AVX2 1
+#endif
+
+/* Bytes holding a block's deltas. Loads and stores touch 8 bytes, so they may
+ * reach into the next block (masked off) and the arena keeps slack at its end. */
+#define PACKED_BYTES(width) ((SEGTREE_PACKED_BLOCK * (width) + 7) / 8)
+#define PACKED_SLACK 8
+
+static inline int combine_packed(const segtree_packed_t *pt, int a, int b) {
+    switch (pt->op_type) {
+        case SEGTREE_MIN:
+            return a < b ? a : b;
+        case SEGTREE_MAX:
+            return a > b ? a : b;
+        default:
+            return (int)((unsigned int)a + (unsigned int)b);
+    }
+}
+
+static inline int block_length(const segtree_packed_t *pt, int block) {
+    int remaining = pt->size - block * SEGTREE_PACKED_BLOCK;
+    return remaining < SEGTREE_PACKED_BLOCK ? remaining : SEGTREE_PACKED_BLOCK;
+}
+
+static inline uint32_t delta_mask(int width) {
+    return width >= 32 ? 0xffffffffu : ((uint32_t)1 << width) - 1;
+}
+
+static inline uint8_t* block_data(const segtree_packed_t *pt, const segtree_packed_block_t *block) {
+    return pt->arena + block->offset;
+}
+
+static inline uint32_t read_delta(const segtree_packed_t *pt, const segtree_packed_block_t *block, int i) {
+    if (block->width == 0) {
+        return 0;
+    }
+
+    size_t bitpos = (size_t)i * block->width;
+    uint64_t word;
+    memcpy(&word, block_data(pt, block) + (bitpos >> 3), sizeof(word));
+    return (uint32_t)(word >> (bitpos & 7)) & delta_mask(block->width);
+}
+
+static inline void write_delta(segtree_packed_t *pt, segtree_packed_block_t *block, int i, uint32_t delta) {
+    if (block->width == 0) {
+        return;
+    }
+
+    size_t bitpos = (size_t)i * block->width;
+    uint8_t *data = block_data(pt, block);
+    uint64_t word;
+    memcpy(&word, data + (bitpos >> 3), sizeof(word));
+    word &= ~((uint64_t)delta_mask(block->width) << (bitpos & 7));
+    word |= (uint64_t)delta << (bitpos & 7);
+    memcpy(data + (bitpos >> 3), &word, sizeof(word));
+}
+
+static void decode_scalar(const segtree_packed_t *pt, const segtree_packed_block_t *block,
+                          int from, int count, uint32_t *out) {
+    for (int i = 0; i < count; i++) {
+        out[i] = read_delta(pt, block, from + i);
+    }
+}
+
+#ifdef SEGTREE_PACKED_AVX2
+/* Eight deltas per step: gather the 32-bit word holding each delta, then shift and mask. */
+__attribute__((target("avx2")))
+static void decode_avx2(const segtree_packed_t *pt, const segtree_packed_block_t *block,
+                        int from, int count, uint32_t *out) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i width = _mm256_set1_epi32(block->width);
+    const __m256i mask = _mm256_set1_epi32((int)delta_mask(block->width));
+    const __m256i seven = _mm256_set1_epi32(7);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i index = _mm256_add_epi32(_mm256_set1_epi32(from + i), lanes);
+        __m256i bitpos = _mm256_mullo_epi32(index, width);
+        __m256i bytes = _mm256_srli_epi32(bitpos, 3);
+        __m256i raw = _mm256_i32gather_epi32((const int*)block_data(pt, block), bytes, 1);
+        __m256i shifted = _mm256_srlv_epi32(raw, _mm256_and_si256(bitpos, seven));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_and_si256(shifted, mask));
+    }
+
+    for (; i < count; i++) {
+        out[i] = read_delta(pt, block, from + i);
+    }
+}
+
+static int cpu_has_avx2(void) {
+    static int cached = -1;
+    if (cached < 0) {
+        __builtin_cpu_init();
+        cached = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return cached;
+}
+#endif
+
+static void decode_deltas(const segtree_packed_t *pt, const segtree_packed_block_t *block,
+                          int from, int count, uint32_t *out) {
+#ifdef SEGTREE_PACKED_AVX2
+    /* A 32-bit gather covers the delta only while shift + width <= 32. */
+    if (block->width > 0 && block->width <= 25 && count >= 8 && cpu_has_avx2()) {
+        decode_avx2(pt, block, from, count, out);
+        return;
+    }
+#endif
+    if (block->width == 0) {
+        memset(out, 0, count * sizeof(uint32_t));
+        return;
+    }
+    decode_scalar(pt, block, from, count, out);
+}
+
+/* Aggregate of leaves [from, to] inside one block. */
+static int reduce_block(const segtree_packed_t *pt, int block_index, int from, int to) {
+    const segtree_packed_block_t *block = &pt->blocks[block_index];
+    uint32_t deltas[SEGTREE_PACKED_BLOCK];
+    int count = to - from + 1;
+
+    decode_deltas(pt, block, from, count, deltas);
+
+    switch (pt->op_type) {
+        case SEGTREE_MIN: {
+            uint32_t best = deltas[0];
+            for (int i = 1; i < count; i++) {
+                best = deltas[i] < best ? deltas[i] : best;
+            }
+            return (int)((uint32_t)block->base + best);
+        }
+        case SEGTREE_MAX: {
+            uint32_t best = deltas[0];
+            for (int i = 1; i < count; i++) {
+                best = deltas[i] > best ? deltas[i] : best;
+            }
+            return (int)((uint32_t)block->base + best);
+        }
+        default: {
+            uint32_t total = 0;
+            for (int i = 0; i < count; i++) {
+                total += deltas[i];
+            }
+            return (int)((uint32_t)block->base * (uint32_t)count + total);
+        }
+    }
+}
+
+static int required_width(uint32_t max_delta) {
+    int width = 0;
+    while (width < 32 && (max_delta >> width) != 0) {
+        width++;
+    }
+    return width;
+}
+
+static int block_width(const int *values, int count, int *base_out) {
+    int base = values[0];
+    for (int i = 1; i < count; i++) {
+        base = values[i] < base ? values[i] : base;
+    }
+
+    uint32_t max_delta = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t delta = (uint32_t)values[i] - (uint32_t)base;
+        max_delta = delta > max_delta ? delta : max_delta;
+    }
+
+    *base_out = base;
+    return required_width(max_delta);
+}
+
+/* Moves every block's deltas into a fresh arena with free space for at least
+ * extra more bytes; blocks are left alone if the allocation fails. */
+static bool arena_grow(segtree_packed_t *pt, size_t extra) {
+    size_t live = 0;
+    for (int b = 0; b < pt->block_count; b++) {
+        live += PACKED_BYTES(pt->blocks[b].width);
+    }
+
+    size_t capacity = 2 * (live + extra) + PACKED_SLACK;
+    uint8_t *arena = (uint8_t*)calloc(capacity, 1);
+    if (arena == NULL) {
+        return false;
+    }
+
+    size_t used = 0;
+    for (int b = 0; b < pt->block_count; b++) {
+        segtree_packed_block_t *block = &pt->blocks[b];
+        size_t bytes = PACKED_BYTES(block->width);
+        memcpy(arena + used, block_data(pt, block), bytes);
+        block->offset = (uint32_t)used;
+        block->room = (uint32_t)bytes;
+        used += bytes;
+    }
+
+    free(pt->arena);
+    pt->arena = arena;
+    pt->arena_used = used;
+    pt->arena_capacity = capacity;
+    return true;
+}
+
+/* (Re)packs a block from full-width values. A wider block moves to the end of
+ * the arena; on allocation failure the block keeps its old contents. */
+static bool encode_block(segtree_packed_t *pt, segtree_packed_block_t *block, const int *values, int count) {
+    int base;
+    int width = block_width(values, count, &base);
+    size_t bytes = PACKED_BYTES(width);
+
+    if (bytes > block->room) {
+        if (pt->arena_used + bytes + PACKED_SLACK > pt->arena_capacity && !arena_grow(pt, bytes)) {
+            return false;
+        }
+        block->offset = (uint32_t)pt->arena_used;
+        block->room = (uint32_t)bytes;
+        pt->arena_used += bytes;
+    }
+
+    memset(block_data(pt, block), 0, block->room);
+    block->base = base;
+    block->width = width;
+
+    for (int i = 0; i < count; i++) {
+        write_delta(pt, block, i, (uint32_t)values[i] - (uint32_t)base);
+    }
+
+    return true;
+}
+
+static void pull_block(segtree_packed_t *pt, int block_index) {
+    int node = pt->capacity + block_index;
+    pt->tree[node] = reduce_block(pt, block_index, 0, block_length(pt, block_index) - 1);
+
+    for (node /= 2; node >= 1; node /= 2) {
+        pt->tree[node] = combine_packed(pt, pt->tree[2 * node], pt->tree[2 * node + 1]);
+    }
+}
+
+segtree_packed_t* segtree_packed_create(int *arr, int n, segtree_operation_t op) {
+    if (arr == NULL || n <= 0 || n > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    if (op != SEGTREE_SUM && op != SEGTREE_MIN && op != SEGTREE_MAX) {
+        return NULL;
+    }
+
+    segtree_packed_t *pt = (segtree_packed_t*)malloc(sizeof(segtree_packed_t));
+    if (pt == NULL) {
+        return NULL;
+    }
+
+    pt->size = n;
+    pt->op_type = op;
+    pt->identity = (op == SEGTREE_MIN) ? SEGTREE_INF : (op == SEGTREE_MAX) ? SEGTREE_NEG_INF : 0;
+    pt->block_count = (n + SEGTREE_PACKED_BLOCK - 1) / SEGTREE_PACKED_BLOCK;
+
+    pt->capacity = 1;
+    while (pt->capacity < pt->block_count) {
+        pt->capacity *= 2;
+    }
+
+    pt->blocks = (segtree_packed_block_t*)calloc(pt->block_count, sizeof(segtree_packed_block_t));
+    pt->tree = (int*)malloc(2 * pt->capacity * sizeof(int));
+    pt->arena = NULL;
+    if (pt->blocks == NULL || pt->tree == NULL) {
+        segtree_packed_destroy(pt);
+        return NULL;
+    }
+
+    /* Size every block first so all deltas land in one exact allocation. */
+    size_t total = 0;
+    for (int b = 0; b < pt->block_count; b++) {
+        int base;
+        int width = block_width(arr + (size_t)b * SEGTREE_PACKED_BLOCK, block_length(pt, b), &base);
+        pt->blocks[b].offset = (uint32_t)total;
+        pt->blocks[b].room = (uint32_t)PACKED_BYTES(width);
+        total += PACKED_BYTES(width);
+    }
+
+    pt->arena_used = total;
+    pt->arena_capacity = total + PACKED_SLACK;
+    pt->arena = (uint8_t*)calloc(pt->arena_capacity, 1);
+    if (pt->arena == NULL) {
+        segtree_packed_destroy(pt);
+        return NULL;
+    }
+
+    for (int b = 0; b < pt->block_count; b++) {
+        encode_block(pt, &pt->blocks[b], arr + (size_t)b * SEGTREE_PACKED_BLOCK, block_length(pt, b));
+        pt->tree[pt->capacity + b] = reduce_block(pt, b, 0, block_length(pt, b) - 1);
+    }
+
+    for (int b = pt->block_count; b < pt->capacity; b++) {
+        pt->tree[pt->capacity + b] = pt->identity;
+    }
+
+    for (int node = pt->capacity - 1; node >= 1; node--) {
+        pt->tree[node] = combine_packed(pt, pt->tree[2 * node], pt->tree[2 * node + 1]);
+    }
+
+    memset(&pt->stats, 0, sizeof(segtree_stats_t));
+
+    return pt;
+}
+
+void segtree_packed_destroy(segtree_packed_t *pt) {
+    if (pt == NULL) {
+        return;
+    }
+
+    free(pt->arena);
+    free(pt->blocks);
+    free(pt->tree);
+    free(pt);
+}
+
+segtree_error_t segtree_packed_query(segtree_packed_t *pt, int left, int right, int *result) {
+    if (pt == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= pt->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int first = left / SEGTREE_PACKED_BLOCK;
+    int last = right / SEGTREE_PACKED_BLOCK;
+    int value;
+
+    if (first == last) {
+        value = reduce_block(pt, first, left % SEGTREE_PACKED_BLOCK, right % SEGTREE_PACKED_BLOCK);
+    } else {
+        value = reduce_block(pt, first, left % SEGTREE_PACKED_BLOCK, SEGTREE_PACKED_BLOCK - 1);
+
+        int right_value = reduce_block(pt, last, 0, right % SEGTREE_PACKED_BLOCK);
+        for (int l = first + 1 + pt->capacity, r = last + pt->capacity; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                value = combine_packed(pt, value, pt->tree[l++]);
+            }
+            if (r & 1) {
+                right_value = combine_packed(pt, pt->tree[--r], right_value);
+            }
+        }
+
+        value = combine_packed(pt, value, right_value);
+    }
+
+    *result = value;
+
+    unsigned long long end_time = segtree_clock_ns();
+    pt->stats.query_count++;
+    pt->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_packed_get(segtree_packed_t *pt, int index, int *value) {
+    if (pt == NULL || value == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= pt->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    const segtree_packed_block_t *block = &pt->blocks[index / SEGTREE_PACKED_BLOCK];
+    *value = (int)((uint32_t)block->base + read_delta(pt, block, index % SEGTREE_PACKED_BLOCK));
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_packed_update_point(segtree_packed_t *pt, int index, int value) {
+    if (pt == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= pt->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int block_index = index / SEGTREE_PACKED_BLOCK;
+    int offset = index % SEGTREE_PACKED_BLOCK;
+    segtree_packed_block_t *block = &pt->blocks[block_index];
+    uint32_t delta = (uint32_t)value - (uint32_t)block->base;
+
+    if (value >= block->base && (delta & ~delta_mask(block->width)) == 0) {
+        write_delta(pt, block, offset, delta);
+    } else {
+        /* The value falls outside the block's base/width: repack the whole block. */
+        int values[SEGTREE_PACKED_BLOCK];
+        int count = block_length(pt, block_index);
+        uint32_t deltas[SEGTREE_PACKED_BLOCK];
+
+        decode_deltas(pt, block, 0, count, deltas);
+        for (int i = 0; i < count; i++) {
+            values[i] = (int)((uint32_t)block->base + deltas[i]);
+        }
+        values[offset] = value;
+
+        if (!encode_block(pt, block, values, count)) {
+            return SEGTREE_ERROR_MEMORY_ALLOCATION;
+        }
+    }
+
+    pull_block(pt, block_index);
+
+    unsigned long long end_time = segtree_clock_ns();
+    pt->stats.update_count++;
+    pt->stats.total_update_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+size_t segtree_packed_memory_usage(segtree_packed_t *pt) {
+    if (pt == NULL) {
+        return 0;
+    }
+
+    size_t bytes = sizeof(segtree_packed_t);
+    bytes += (size_t)pt->block_count * sizeof(segtree_packed_block_t);
+    bytes += (size_t)2 * pt->capacity * sizeof(int);
+    bytes += pt->arena_capacity;
+
+    return bytes;
+}
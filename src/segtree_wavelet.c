@@ -0,0 +1,253 @@
+#include "../include/segtree_wavelet.h"
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static inline uint64_t* level_bits(const segtree_wavelet_t *wt, int level) {
+    return wt->bits + (size_t)level * wt->words_per_level;
+}
+
+static inline unsigned int* level_ranks(const segtree_wavelet_t *wt, int level) {
+    return wt->ranks + (size_t)level * wt->words_per_level;
+}
+
+/* Number of ones in positions [0, i) of the given level. */
+static inline int rank1(const segtree_wavelet_t *wt, int level, int i) {
+    const uint64_t *bits = level_bits(wt, level);
+    const unsigned int *ranks = level_ranks(wt, level);
+    uint64_t mask = (((uint64_t)1) << (i & 63)) - 1;
+    return (int)ranks[i >> 6] + __builtin_popcountll(bits[i >> 6] & mask);
+}
+
+static inline int rank0(const segtree_wavelet_t *wt, int level, int i) {
+    return i - rank1(wt, level, i);
+}
+
+/* Number of compressed values <= x, i.e. the first code greater than x. */
+static int upper_code(const segtree_wavelet_t *wt, int x) {
+    int lo = 0;
+    int hi = wt->value_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (wt->values[mid] <= x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int lower_code(const segtree_wavelet_t *wt, int x) {
+    int lo = 0;
+    int hi = wt->value_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (wt->values[mid] < x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+segtree_wavelet_t* segtree_wavelet_create(int *arr, int n) {
+    if (arr == NULL || n <= 0 || n > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    segtree_wavelet_t *wt = (segtree_wavelet_t*)malloc(sizeof(segtree_wavelet_t));
+    if (wt == NULL) {
+        return NULL;
+    }
+
+    wt->size = n;
+    wt->values = (int*)malloc(n * sizeof(int));
+    int *codes = (int*)malloc(n * sizeof(int));
+    int *next = (int*)malloc(n * sizeof(int));
+    if (wt->values == NULL || codes == NULL || next == NULL) {
+        free(wt->values);
+        free(codes);
+        free(next);
+        free(wt);
+        return NULL;
+    }
+
+    memcpy(wt->values, arr, n * sizeof(int));
+    qsort(wt->values, n, sizeof(int), compare_ints);
+
+    int distinct = 0;
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || wt->values[i] != wt->values[distinct - 1]) {
+            wt->values[distinct++] = wt->values[i];
+        }
+    }
+    wt->value_count = distinct;
+
+    for (int i = 0; i < n; i++) {
+        codes[i] = lower_code(wt, arr[i]);
+    }
+
+    wt->levels = 1;
+    while ((1 << wt->levels) < distinct) {
+        wt->levels++;
+    }
+
+    wt->words_per_level = n / 64 + 1;
+    size_t words = (size_t)wt->levels * wt->words_per_level;
+    wt->bits = (uint64_t*)calloc(words, sizeof(uint64_t));
+    wt->ranks = (unsigned int*)malloc(words * sizeof(unsigned int));
+    wt->zeros = (int*)malloc(wt->levels * sizeof(int));
+    if (wt->bits == NULL || wt->ranks == NULL || wt->zeros == NULL) {
+        free(codes);
+        free(next);
+        segtree_wavelet_destroy(wt);
+        return NULL;
+    }
+
+    /* Each level stably partitions codes by the current bit, zeros first. */
+    for (int level = 0; level < wt->levels; level++) {
+        int shift = wt->levels - 1 - level;
+        uint64_t *bits = level_bits(wt, level);
+        unsigned int *ranks = level_ranks(wt, level);
+
+        int zero_count = 0;
+        for (int i = 0; i < n; i++) {
+            if ((codes[i] >> shift) & 1) {
+                bits[i >> 6] |= ((uint64_t)1) << (i & 63);
+            } else {
+                zero_count++;
+            }
+        }
+
+        unsigned int ones = 0;
+        for (int w = 0; w < wt->words_per_level; w++) {
+            ranks[w] = ones;
+            ones += (unsigned int)__builtin_popcountll(bits[w]);
+        }
+
+        int zero_pos = 0;
+        int one_pos = zero_count;
+        for (int i = 0; i < n; i++) {
+            if ((codes[i] >> shift) & 1) {
+                next[one_pos++] = codes[i];
+            } else {
+                next[zero_pos++] = codes[i];
+            }
+        }
+
+        wt->zeros[level] = zero_count;
+        int *swap = codes;
+        codes = next;
+        next = swap;
+    }
+
+    free(codes);
+    free(next);
+
+    memset(&wt->stats, 0, sizeof(segtree_stats_t));
+
+    return wt;
+}
+
+void segtree_wavelet_destroy(segtree_wavelet_t *wt) {
+    if (wt == NULL) {
+        return;
+    }
+
+    free(wt->values);
+    free(wt->bits);
+    free(wt->ranks);
+    free(wt->zeros);
+    free(wt);
+}
+
+segtree_error_t segtree_wavelet_kth_smallest(segtree_wavelet_t *wt, int left, int right, int k, int *result) {
+    if (wt == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= wt->size || left > right || k < 1 || k > right - left + 1) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int begin = left;
+    int end = right + 1;
+    int rank = k - 1;
+    int code = 0;
+
+    for (int level = 0; level < wt->levels; level++) {
+        int zeros_before = rank0(wt, level, begin);
+        int zeros_through = rank0(wt, level, end);
+        int zeros_in = zeros_through - zeros_before;
+
+        code <<= 1;
+        if (rank < zeros_in) {
+            begin = zeros_before;
+            end = zeros_through;
+        } else {
+            rank -= zeros_in;
+            code |= 1;
+            begin = wt->zeros[level] + (begin - zeros_before);
+            end = wt->zeros[level] + (end - zeros_through);
+        }
+    }
+
+    *result = wt->values[code];
+
+    unsigned long long end_time = segtree_clock_ns();
+    wt->stats.query_count++;
+    wt->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_wavelet_count_leq(segtree_wavelet_t *wt, int left, int right, int x, int *count) {
+    if (wt == NULL || count == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (left < 0 || right >= wt->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    unsigned long long start_time = segtree_clock_ns();
+
+    int bound = upper_code(wt, x);
+    int begin = left;
+    int end = right + 1;
+    int less = 0;
+
+    if (bound >= (1 << wt->levels)) {
+        less = end - begin;
+    } else {
+        /* Count codes strictly below bound by following bound's bits. */
+        for (int level = 0; level < wt->levels && begin < end; level++) {
+            int zeros_before = rank0(wt, level, begin);
+            int zeros_through = rank0(wt, level, end);
+
+            if ((bound >> (wt->levels - 1 - level)) & 1) {
+                less += zeros_through - zeros_before;
+                begin = wt->zeros[level] + (begin - zeros_before);
+                end = wt->zeros[level] + (end - zeros_through);
+            } else {
+                begin = zeros_before;
+                end = zeros_through;
+            }
+        }
+    }
+
+    *count = less;
+
+    unsigned long long end_time = segtree_clock_ns();
+    wt->stats.query_count++;
+    wt->stats.total_query_time += (double)(end_time - start_time) / 1e9;
+
+    return SEGTREE_OK;
+}
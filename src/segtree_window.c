@@ -0,0 +1,128 @@
+#include "../include/segtree_window.h"
+
+static inline int combine_window(const segtree_window_t *wt, int a, int b) {
+    switch (wt->op_type) {
+        case SEGTREE_MIN:
+            return a < b ? a : b;
+        case SEGTREE_MAX:
+            return a > b ? a : b;
+        default:
+            return a + b;
+    }
+}
+
+segtree_window_t* segtree_window_create(int window, segtree_operation_t op) {
+    if (window <= 0 || window > SEGTREE_MAX_SIZE) {
+        return NULL;
+    }
+
+    if (op != SEGTREE_SUM && op != SEGTREE_MIN && op != SEGTREE_MAX) {
+        return NULL;
+    }
+
+    segtree_window_t *wt = (segtree_window_t*)malloc(sizeof(segtree_window_t));
+    if (wt == NULL) {
+        return NULL;
+    }
+
+    wt->window = window;
+    wt->capacity = 1;
+    while (wt->capacity < window) {
+        wt->capacity *= 2;
+    }
+
+    wt->tree = (int*)malloc(2 * wt->capacity * sizeof(int));
+    if (wt->tree == NULL) {
+        free(wt);
+        return NULL;
+    }
+
+    wt->op_type = op;
+    wt->identity = (op == SEGTREE_MIN) ? SEGTREE_INF : (op == SEGTREE_MAX) ? SEGTREE_NEG_INF : 0;
+    wt->head = 0;
+    wt->count = 0;
+
+    for (int i = 0; i < 2 * wt->capacity; i++) {
+        wt->tree[i] = wt->identity;
+    }
+
+    memset(&wt->stats, 0, sizeof(segtree_stats_t));
+
+    return wt;
+}
+
+void segtree_window_destroy(segtree_window_t *wt) {
+    if (wt == NULL) {
+        return;
+    }
+
+    free(wt->tree);
+    free(wt);
+}
+
+/* Streaming hot path: counted in stats but not timed, the clock read would dominate. */
+segtree_error_t segtree_window_push(segtree_window_t *wt, int value) {
+    if (wt == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    int node = wt->capacity + wt->head;
+    wt->tree[node] = value;
+    for (node /= 2; node >= 1; node /= 2) {
+        wt->tree[node] = combine_window(wt, wt->tree[2 * node], wt->tree[2 * node + 1]);
+    }
+
+    if (++wt->head == wt->window) {
+        wt->head = 0;
+    }
+    if (wt->count < wt->window) {
+        wt->count++;
+    }
+
+    wt->stats.update_count++;
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_window_query(segtree_window_t *wt, int k, int *result) {
+    if (wt == NULL || result == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (k <= 0 || k > wt->count) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    int first = wt->head - k;
+    int value = wt->identity;
+
+    if (first >= 0) {
+        for (int l = first + wt->capacity, r = wt->head + wt->capacity; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                value = combine_window(wt, value, wt->tree[l++]);
+            }
+            if (r & 1) {
+                value = combine_window(wt, value, wt->tree[--r]);
+            }
+        }
+    } else {
+        /*
+         * The window wraps: walk the suffix [first + window, capacity) and the
+         * prefix [0, head) in the same pass. Slots past window hold identity.
+         */
+        int l = first + wt->window + wt->capacity;
+        int r = wt->head + wt->capacity;
+        for (int low = wt->capacity, high = 2 * wt->capacity; low >= 1; low /= 2, high /= 2, l /= 2, r /= 2) {
+            if (l < high && (l & 1)) {
+                value = combine_window(wt, value, wt->tree[l++]);
+            }
+            if (r > low && (r & 1)) {
+                value = combine_window(wt, value, wt->tree[--r]);
+            }
+        }
+    }
+
+    *result = value;
+
+    wt->stats.query_count++;
+    return SEGTREE_OK;
+}
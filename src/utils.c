@@ -1,7 +1,11 @@
+#define _XOPEN_SOURCE 700
+
 #include "../include/segment_tree.h"
+#include <pthread.h>
+#include <unistd.h>
 
 static void print_tree_recursive(segment_tree_t *st, int node, int start, int end, int depth) {
-    if (node >= st->tree_size || start > end) {
+    if (node >= st->tree_size || start > end || start >= st->size) {
         return;
     }
 
@@ -33,57 +37,76 @@ void segtree_print(segment_tree_t *st) {
     }
 
     printf("=== Segment Tree Debug Info ===\n");
-    printf("Size: %d, Tree Size: %d\n", st->size, st->tree_size);
+    printf("Size: %d, Capacity: %d, Tree Size: %d\n", st->size, st->capacity, st->tree_size);
     printf("Operation Type: %d, Lazy Enabled: %s\n",
            st->op_type, st->lazy_enabled ? "Yes" : "No");
     printf("Identity: %d\n", st->identity);
-    printf("Stats - Queries: %d, Updates: %d\n",
+    printf("Stats - Queries: %llu, Updates: %llu\n",
            st->stats.query_count, st->stats.update_count);
     printf("=== Tree Structure ===\n");
 
     if (st->size > 0) {
-        print_tree_recursive(st, 1, 0, st->size - 1, 0);
+        print_tree_recursive(st, 1, 0, st->capacity - 1, 0);
     }
 
     printf("=== End Debug Info ===\n\n");
 }
 
-static bool validate_tree_recursive(segment_tree_t *st, int node, int start, int end) {
-    if (node >= st->tree_size || start > end || start < 0 || end >= st->size) {
-        return false;
+static inline int combine_children(const segment_tree_t *st, int node) {
+    int a = st->tree[2 * node];
+    int b = st->tree[2 * node + 1];
+    switch (st->op_type) {
+        case SEGTREE_SUM:
+            return (int)((unsigned int)a + (unsigned int)b);
+        case SEGTREE_MIN:
+            return (a < b) ? a : b;
+        case SEGTREE_MAX:
+            return (a > b) ? a : b;
+        default:
+            return st->combine(a, b);
     }
+}
 
-    if (start == end) {
-        return true;
+/* Local invariant of a node with len leaves under it: it equals the combine
+ * of its children plus its own pending tag. Leaves past size must hold the
+ * identity. */
+static inline bool node_valid(const segment_tree_t *st, int node, int len) {
+    if (node >= st->capacity) {
+        return node - st->capacity < st->size || st->tree[node] == st->identity;
     }
 
-    int mid = (start + end) / 2;
-    int left_child = 2 * node;
-    int right_child = 2 * node + 1;
+    int expected = combine_children(st, node);
 
-    if (left_child >= st->tree_size || right_child >= st->tree_size) {
-        return false;
+    if (st->lazy_enabled && st->lazy[node] != st->identity) {
+        if (st->op_type == SEGTREE_MIN || st->op_type == SEGTREE_MAX) {
+            expected = st->lazy[node];
+        } else {
+            expected = (int)((unsigned int)expected + (unsigned int)st->lazy[node] * (unsigned int)len);
+        }
     }
 
-    bool left_valid = validate_tree_recursive(st, left_child, start, mid);
-    bool right_valid = validate_tree_recursive(st, right_child, mid + 1, end);
+    return st->tree[node] == expected;
+}
 
-    if (!left_valid || !right_valid) {
-        return false;
+/* Checks every node in [first, last). Nothing is written, so ranges can be
+ * checked concurrently. */
+static bool validate_nodes(const segment_tree_t *st, int first, int last) {
+    /* len halves at each power of two. */
+    int level_end = 1;
+    int len = st->capacity;
+    while (level_end <= first) {
+        level_end *= 2;
+        len /= 2;
     }
+    len *= 2;
 
-    if (st->lazy_enabled && st->propagate != NULL) {
-        segment_tree_t temp_st = *st;
-        temp_st.propagate(&temp_st, left_child, start, mid);
-        temp_st.propagate(&temp_st, right_child, mid + 1, end);
-
-        int expected = st->combine(temp_st.tree[left_child], temp_st.tree[right_child]);
-        if (st->tree[node] != expected) {
-            return false;
+    for (int node = first; node < last; node++) {
+        if (node == level_end) {
+            level_end *= 2;
+            len /= 2;
         }
-    } else {
-        int expected = st->combine(st->tree[left_child], st->tree[right_child]);
-        if (st->tree[node] != expected) {
+
+        if (!node_valid(st, node, len)) {
             return false;
         }
     }
@@ -91,12 +114,12 @@ static bool validate_tree_recursive(segment_tree_t *st, int node, int start, int
     return true;
 }
 
-bool segtree_validate(segment_tree_t *st) {
+static bool validate_shape(const segment_tree_t *st) {
     if (st == NULL || st->tree == NULL) {
         return false;
     }
 
-    if (st->size <= 0 || st->tree_size <= 0) {
+    if (st->size <= 0 || st->size > st->capacity || st->tree_size != 2 * st->capacity) {
         return false;
     }
 
@@ -110,17 +133,108 @@ bool segtree_validate(segment_tree_t *st) {
         }
     }
 
-    if (st->size == 1) {
-        return true;
+    return true;
+}
+
+typedef struct {
+    const segment_tree_t *st;
+    int first;
+    int last;
+    bool valid;
+} validate_task_t;
+
+static void* validate_worker(void *arg) {
+    validate_task_t *task = (validate_task_t*)arg;
+    task->valid = validate_nodes(task->st, task->first, task->last);
+    return NULL;
+}
+
+bool segtree_validate(segment_tree_t *st) {
+    return segtree_validate_parallel(st, 1);
+}
+
+bool segtree_validate_parallel(segment_tree_t *st, int threads) {
+    if (!validate_shape(st)) {
+        return false;
+    }
+
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (int)online : 1;
+    }
+
+    /* Below this many nodes per thread the spawn cost dominates. */
+    int max_threads = st->tree_size / SEGTREE_VALIDATE_MIN_NODES;
+    if (threads > max_threads) {
+        threads = max_threads;
+    }
+    if (threads > SEGTREE_VALIDATE_MAX_THREADS) {
+        threads = SEGTREE_VALIDATE_MAX_THREADS;
     }
 
-    return validate_tree_recursive(st, 1, 0, st->size - 1);
+    if (threads <= 1) {
+        return validate_nodes(st, 1, st->tree_size);
+    }
+
+    pthread_t workers[SEGTREE_VALIDATE_MAX_THREADS];
+    bool launched[SEGTREE_VALIDATE_MAX_THREADS];
+    validate_task_t tasks[SEGTREE_VALIDATE_MAX_THREADS];
+    int chunk = (st->tree_size - 1 + threads - 1) / threads;
+
+    for (int t = 0; t < threads; t++) {
+        tasks[t].st = st;
+        tasks[t].first = 1 + t * chunk;
+        tasks[t].last = (tasks[t].first + chunk < st->tree_size) ? tasks[t].first + chunk : st->tree_size;
+        tasks[t].valid = false;
+
+        /* The calling thread takes the last chunk, and any chunk whose worker failed to start. */
+        launched[t] = (t < threads - 1 &&
+                       pthread_create(&workers[t], NULL, validate_worker, &tasks[t]) == 0);
+        if (!launched[t]) {
+            validate_worker(&tasks[t]);
+        }
+    }
+
+    bool valid = true;
+    for (int t = 0; t < threads; t++) {
+        if (launched[t]) {
+            pthread_join(workers[t], NULL);
+        }
+        valid = valid && tasks[t].valid;
+    }
+
+    return valid;
+}
+
+/* Checks k random root-to-leaf paths: O(k log n), for trees too large to
+ * scan on every health check. */
+bool segtree_validate_sampled(segment_tree_t *st, int paths, unsigned int seed) {
+    if (!validate_shape(st) || paths < 0) {
+        return false;
+    }
+
+    unsigned int state = seed ? seed : 0x9e3779b9u;
+    for (int p = 0; p < paths; p++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        int node = st->capacity + (int)(state % (unsigned int)st->capacity);
+        for (int len = 1; node >= 1; node /= 2, len *= 2) {
+            if (!node_valid(st, node, len)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
 }
 
 segtree_stats_t segtree_get_stats(segment_tree_t *st) {
-    segtree_stats_t empty_stats = {0, 0, 0.0, 0.0};
+    segtree_stats_t empty_stats;
 
     if (st == NULL) {
+        memset(&empty_stats, 0, sizeof(segtree_stats_t));
         return empty_stats;
     }
 
@@ -132,10 +246,7 @@ void segtree_reset_stats(segment_tree_t *st) {
         return;
     }
 
-    st->stats.query_count = 0;
-    st->stats.update_count = 0;
-    st->stats.total_query_time = 0.0;
-    st->stats.total_update_time = 0.0;
+    memset(&st->stats, 0, sizeof(segtree_stats_t));
 }
 
 void segtree_print_stats(segment_tree_t *st) {
@@ -145,8 +256,8 @@ void segtree_print_stats(segment_tree_t *st) {
     }
 
     printf("=== Segment Tree Statistics ===\n");
-    printf("Total Queries: %d\n", st->stats.query_count);
-    printf("Total Updates: %d\n", st->stats.update_count);
+    printf("Total Queries: %llu\n", st->stats.query_count);
+    printf("Total Updates: %llu\n", st->stats.update_count);
     printf("Total Query Time: %.6f seconds\n", st->stats.total_query_time);
     printf("Total Update Time: %.6f seconds\n", st->stats.total_update_time);
 
@@ -160,5 +271,35 @@ void segtree_print_stats(segment_tree_t *st) {
                st->stats.total_update_time / st->stats.update_count);
     }
 
+    if (st->cache != NULL) {
+        printf("Cache Hits: %llu, Cache Misses: %llu\n",
+               st->stats.cache_hits, st->stats.cache_misses);
+    }
+
+    if (st->write_buffer != NULL) {
+        printf("Coalesced Writes: %llu, Buffer Flushes: %llu\n",
+               st->stats.coalesced_writes, st->stats.buffer_flushes);
+    }
+
+    static const char *perf_names[SEGTREE_PERF_OP_COUNT] = {
+        "query", "update_point", "update_range", "build"
+    };
+
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        const segtree_perf_counters_t *c = &st->stats.perf[op];
+        if (c->samples == 0) {
+            continue;
+        }
+
+        printf("[perf %s] samples: %llu, cycles/op: %.1f, IPC: %.2f, "
+               "L1D miss/op: %.2f, LLC miss/op: %.2f, dTLB miss/op: %.2f\n",
+               perf_names[op], c->samples,
+               (double)c->cycles / c->samples,
+               c->cycles > 0 ? (double)c->instructions / c->cycles : 0.0,
+               (double)c->l1d_misses / c->samples,
+               (double)c->llc_misses / c->samples,
+               (double)c->dtlb_misses / c->samples);
+    }
+
     printf("================================\n\n");
 }
\ No newline at end of file
@@ -0,0 +1,616 @@
+#define _XOPEN_SOURCE 700
+#define _FILE_OFFSET_BITS 64
+
+#include "wal.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define WAL_SNAPSHOT_MAGIC "SEGTSNP1"
+
+/* One logged mutation; lsn numbers records contiguously from 1. */
+typedef struct {
+    uint64_t lsn;
+    int32_t op;
+    int32_t a;
+    int32_t b;
+    int32_t value;
+    uint32_t reserved;
+    uint32_t checksum;
+} wal_record_t;
+
+typedef struct {
+    char magic[8];
+    uint64_t lsn;
+    int32_t op_type;
+    int32_t lazy;
+    int32_t size;
+    uint32_t reserved;
+    uint64_t checksum;
+} wal_snapshot_header_t;
+
+/* The flusher thread shares pending, group, fd and failed with the
+ * mutating thread; lock guards all of them. It never touches the tree. */
+struct segtree_wal {
+    int fd;
+    char *log_path;
+    char *snapshot_path;
+    segtree_wal_sync_t sync;
+    wal_record_t *group;
+    int group_records;
+    int pending;
+    uint64_t next_lsn;
+    long long checkpoint_records;
+    long long since_checkpoint;
+    bool failed;
+    unsigned long long oldest_ns;
+    unsigned long long group_delay_ns;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_t flusher;
+    bool flusher_running;
+    bool stopping;
+};
+
+static uint32_t record_checksum(const wal_record_t *record) {
+    const unsigned char *bytes = (const unsigned char*)record;
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(wal_record_t, checksum); i++) {
+        h = (h ^ bytes[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint64_t data_checksum(const int *data, int n) {
+    const unsigned char *bytes = (const unsigned char*)data;
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < (size_t)n * sizeof(int); i++) {
+        h = (h ^ bytes[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+static bool write_all(int fd, const void *buffer, size_t bytes) {
+    const char *p = (const char*)buffer;
+    while (bytes > 0) {
+        ssize_t written = write(fd, p, bytes);
+        if (written <= 0) {
+            return false;
+        }
+        p += written;
+        bytes -= (size_t)written;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void *buffer, size_t bytes) {
+    char *p = (char*)buffer;
+    while (bytes > 0) {
+        ssize_t got = read(fd, p, bytes);
+        if (got <= 0) {
+            return false;
+        }
+        p += got;
+        bytes -= (size_t)got;
+    }
+    return true;
+}
+
+static char* copy_string(const char *s) {
+    char *copy = (char*)malloc(strlen(s) + 1);
+    if (copy != NULL) {
+        strcpy(copy, s);
+    }
+    return copy;
+}
+
+static void stop_flusher(struct segtree_wal *wal) {
+    if (!wal->flusher_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&wal->lock);
+    wal->stopping = true;
+    pthread_cond_signal(&wal->wake);
+    pthread_mutex_unlock(&wal->lock);
+
+    pthread_join(wal->flusher, NULL);
+    wal->flusher_running = false;
+    wal->stopping = false;
+}
+
+static void wal_free(struct segtree_wal *wal) {
+    stop_flusher(wal);
+    pthread_mutex_destroy(&wal->lock);
+    pthread_cond_destroy(&wal->wake);
+    if (wal->fd >= 0) {
+        close(wal->fd);
+    }
+    free(wal->log_path);
+    free(wal->snapshot_path);
+    free(wal->group);
+    free(wal);
+}
+
+static struct segtree_wal* wal_open(const char *log_path, const char *snapshot_path,
+                                    segtree_wal_sync_t sync, int group_records,
+                                    long long checkpoint_records) {
+    struct segtree_wal *wal = (struct segtree_wal*)calloc(1, sizeof(struct segtree_wal));
+    if (wal == NULL) {
+        return NULL;
+    }
+
+    /* The flusher waits on the same clock segtree_clock_ns reads. */
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wal->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&wal->lock, NULL);
+
+    wal->fd = -1;
+    wal->log_path = copy_string(log_path);
+    wal->snapshot_path = copy_string(snapshot_path);
+    wal->group = (wal_record_t*)malloc((size_t)group_records * sizeof(wal_record_t));
+    if (wal->log_path == NULL || wal->snapshot_path == NULL || wal->group == NULL) {
+        wal_free(wal);
+        return NULL;
+    }
+
+    wal->fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (wal->fd < 0) {
+        wal_free(wal);
+        return NULL;
+    }
+
+    wal->sync = sync;
+    wal->group_records = group_records;
+    wal->checkpoint_records = checkpoint_records;
+    wal->next_lsn = 1;
+    wal->group_delay_ns = (unsigned long long)SEGTREE_WAL_GROUP_DELAY_MS * 1000000ULL;
+    return wal;
+}
+
+/* Group commit: every pending record goes out in one write, then one fsync. */
+static segtree_error_t wal_commit(struct segtree_wal *wal) {
+    if (wal->failed) {
+        return SEGTREE_ERROR_IO;
+    }
+
+    if (wal->pending == 0) {
+        return SEGTREE_OK;
+    }
+
+    if (!write_all(wal->fd, wal->group, (size_t)wal->pending * sizeof(wal_record_t)) ||
+        (wal->sync != SEGTREE_WAL_SYNC_NONE && fsync(wal->fd) != 0)) {
+        /* The log may now end in a torn record; recovery drops it, but the
+         * tree has moved on, so no further mutation is accepted. */
+        wal->failed = true;
+        return SEGTREE_ERROR_IO;
+    }
+
+    wal->pending = 0;
+    return SEGTREE_OK;
+}
+
+/* Commits a group once its oldest record has waited group_delay_ns, so a
+ * slow writer never leaves acknowledged records only in memory. */
+static void* flusher_main(void *arg) {
+    struct segtree_wal *wal = (struct segtree_wal*)arg;
+
+    pthread_mutex_lock(&wal->lock);
+    while (!wal->stopping) {
+        if (wal->pending == 0 || wal->failed) {
+            pthread_cond_wait(&wal->wake, &wal->lock);
+            continue;
+        }
+
+        unsigned long long deadline = wal->oldest_ns + wal->group_delay_ns;
+        if (segtree_clock_ns() >= deadline) {
+            wal_commit(wal);
+            continue;
+        }
+
+        struct timespec until;
+        until.tv_sec = (time_t)(deadline / 1000000000ULL);
+        until.tv_nsec = (long)(deadline % 1000000000ULL);
+        pthread_cond_timedwait(&wal->wake, &wal->lock, &until);
+    }
+    pthread_mutex_unlock(&wal->lock);
+
+    return NULL;
+}
+
+static segtree_error_t start_flusher(struct segtree_wal *wal) {
+    if (wal->group_delay_ns == 0 || wal->sync == SEGTREE_WAL_SYNC_EACH) {
+        return SEGTREE_OK;
+    }
+
+    if (pthread_create(&wal->flusher, NULL, flusher_main, wal) != 0) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    wal->flusher_running = true;
+    return SEGTREE_OK;
+}
+
+static bool sync_directory(const char *path) {
+    const char *slash = strrchr(path, '/');
+    char *dir = copy_string(slash == NULL ? "." : path);
+    if (dir == NULL) {
+        return false;
+    }
+    if (slash != NULL) {
+        dir[slash == path ? 1 : slash - path] = '\0';
+    }
+
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = (fsync(fd) == 0);
+    close(fd);
+    return ok;
+}
+
+static bool write_snapshot(segment_tree_t *st, const char *path, uint64_t lsn) {
+    size_t length = strlen(path);
+    char *temp_path = (char*)malloc(length + 5);
+    if (temp_path == NULL) {
+        return false;
+    }
+    memcpy(temp_path, path, length);
+    memcpy(temp_path + length, ".tmp", 5);
+
+    /* Leaves hold the effective values only once every tag is pushed down. */
+    segtree_push_all(st);
+    const int *leaves = st->tree + st->capacity;
+
+    wal_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WAL_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.lsn = lsn;
+    header.op_type = (int32_t)st->op_type;
+    header.lazy = st->lazy_enabled ? 1 : 0;
+    header.size = st->size;
+    header.checksum = data_checksum(leaves, st->size);
+
+    bool ok = false;
+    int fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        ok = write_all(fd, &header, sizeof(header)) &&
+             write_all(fd, leaves, (size_t)st->size * sizeof(int)) &&
+             fsync(fd) == 0;
+        ok = (close(fd) == 0) && ok;
+    }
+
+    ok = ok && rename(temp_path, path) == 0 && sync_directory(path);
+    if (!ok) {
+        unlink(temp_path);
+    }
+
+    free(temp_path);
+    return ok;
+}
+
+/* Called with wal->lock held. */
+static segtree_error_t wal_checkpoint(segment_tree_t *st, struct segtree_wal *wal) {
+    segtree_error_t error = wal_commit(wal);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    /* Buffered writes are logged but not yet in the leaves; the flush
+     * applies them without logging again. */
+    error = segtree_flush(st);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    /* Records at or below the snapshot's lsn are skipped on replay, so a
+     * crash between the rename and the truncate is harmless. */
+    if (!write_snapshot(st, wal->snapshot_path, wal->next_lsn - 1) ||
+        ftruncate(wal->fd, 0) != 0 || fsync(wal->fd) != 0) {
+        wal->failed = true;
+        return SEGTREE_ERROR_IO;
+    }
+
+    wal->since_checkpoint = 0;
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_wal_enable(segment_tree_t *st, const char *log_path, const char *snapshot_path,
+                                   segtree_wal_sync_t sync, int group_records, long long checkpoint_records) {
+    if (st == NULL || log_path == NULL || snapshot_path == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (st->op_type == SEGTREE_CUSTOM) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (group_records <= 0 || checkpoint_records < 0) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    struct segtree_wal *wal = wal_open(log_path, snapshot_path, sync, group_records, checkpoint_records);
+    if (wal == NULL) {
+        return SEGTREE_ERROR_IO;
+    }
+
+    if (wal_checkpoint(st, wal) != SEGTREE_OK) {
+        wal_free(wal);
+        return SEGTREE_ERROR_IO;
+    }
+
+    segtree_error_t error = start_flusher(wal);
+    if (error != SEGTREE_OK) {
+        wal_free(wal);
+        return error;
+    }
+
+    segtree_wal_disable(st);
+    st->wal = wal;
+
+    return SEGTREE_OK;
+}
+
+void segtree_wal_disable(segment_tree_t *st) {
+    if (st == NULL || st->wal == NULL) {
+        return;
+    }
+
+    stop_flusher(st->wal);
+    wal_commit(st->wal);
+    wal_free(st->wal);
+    st->wal = NULL;
+}
+
+segtree_error_t segtree_wal_set_group_delay(segment_tree_t *st, int delay_ms) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (st->wal == NULL) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    stop_flusher(st->wal);
+    st->wal->group_delay_ns = delay_ms > 0 ? (unsigned long long)delay_ms * 1000000ULL : 0;
+    return start_flusher(st->wal);
+}
+
+segtree_error_t segtree_wal_sync(segment_tree_t *st) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (st->wal == NULL) {
+        return SEGTREE_OK;
+    }
+
+    pthread_mutex_lock(&st->wal->lock);
+    segtree_error_t error = wal_commit(st->wal);
+    if (error == SEGTREE_OK && st->wal->sync == SEGTREE_WAL_SYNC_NONE && fsync(st->wal->fd) != 0) {
+        st->wal->failed = true;
+        error = SEGTREE_ERROR_IO;
+    }
+    pthread_mutex_unlock(&st->wal->lock);
+    return error;
+}
+
+segtree_error_t segtree_wal_checkpoint(segment_tree_t *st) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (st->wal == NULL) {
+        return SEGTREE_OK;
+    }
+
+    pthread_mutex_lock(&st->wal->lock);
+    segtree_error_t error = wal_checkpoint(st, st->wal);
+    pthread_mutex_unlock(&st->wal->lock);
+    return error;
+}
+
+segtree_error_t segtree_wal_log(segment_tree_t *st, segtree_wal_op_t op,
+                                const int *a, const int *b, const int *values, int count) {
+    struct segtree_wal *wal = st->wal;
+    segtree_error_t error = SEGTREE_OK;
+
+    pthread_mutex_lock(&wal->lock);
+    if (wal->failed) {
+        pthread_mutex_unlock(&wal->lock);
+        return SEGTREE_ERROR_IO;
+    }
+
+    /* Everything logged so far is applied or buffered by now, so this is the
+     * one point where a snapshot matches the log exactly. */
+    if (wal->checkpoint_records > 0 && wal->since_checkpoint >= wal->checkpoint_records) {
+        error = wal_checkpoint(st, wal);
+        if (error != SEGTREE_OK) {
+            pthread_mutex_unlock(&wal->lock);
+            return error;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (wal->pending == wal->group_records) {
+            error = wal_commit(wal);
+            if (error != SEGTREE_OK) {
+                pthread_mutex_unlock(&wal->lock);
+                return error;
+            }
+        }
+
+        if (wal->pending == 0) {
+            wal->oldest_ns = segtree_clock_ns();
+            pthread_cond_signal(&wal->wake);
+        }
+
+        wal_record_t *record = &wal->group[wal->pending++];
+        record->lsn = wal->next_lsn++;
+        record->op = (int32_t)op;
+        record->a = (a != NULL) ? a[i] : 0;
+        record->b = (b != NULL) ? b[i] : 0;
+        record->value = values[i];
+        record->reserved = 0;
+        record->checksum = record_checksum(record);
+    }
+
+    wal->since_checkpoint += count;
+
+    if (wal->sync == SEGTREE_WAL_SYNC_EACH || wal->pending == wal->group_records) {
+        error = wal_commit(wal);
+    }
+
+    pthread_mutex_unlock(&wal->lock);
+    return error;
+}
+
+typedef struct {
+    segtree_wal_op_t op;
+    int *a;
+    int *b;
+    int *values;
+    int count;
+} replay_run_t;
+
+static segtree_error_t replay_run(segment_tree_t *st, replay_run_t *run) {
+    segtree_error_t error = SEGTREE_OK;
+
+    if (run->count == 0) {
+        return SEGTREE_OK;
+    }
+
+    switch (run->op) {
+        case SEGTREE_WAL_POINT:
+            error = segtree_update_points(st, run->a, run->values, run->count);
+            break;
+        case SEGTREE_WAL_RANGE:
+            error = segtree_update_ranges(st, run->a, run->b, run->values, run->count, NULL);
+            break;
+        case SEGTREE_WAL_APPEND:
+            error = segtree_append_many(st, run->values, run->count);
+            break;
+    }
+
+    run->count = 0;
+    return error;
+}
+
+static segment_tree_t* load_snapshot(const char *path, uint64_t *lsn) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    wal_snapshot_header_t header;
+    int *values = NULL;
+    segment_tree_t *st = NULL;
+
+    if (read_all(fd, &header, sizeof(header)) &&
+        memcmp(header.magic, WAL_SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+        header.size > 0 && header.size <= SEGTREE_MAX_SIZE &&
+        header.op_type >= SEGTREE_SUM && header.op_type < SEGTREE_CUSTOM) {
+        values = (int*)malloc((size_t)header.size * sizeof(int));
+    }
+
+    if (values != NULL && read_all(fd, values, (size_t)header.size * sizeof(int)) &&
+        data_checksum(values, header.size) == header.checksum) {
+        segtree_operation_t op = (segtree_operation_t)header.op_type;
+        st = header.lazy ? segtree_create_lazy(values, header.size, op)
+                         : segtree_create(values, header.size, op);
+        *lsn = header.lsn;
+    }
+
+    free(values);
+    close(fd);
+    return st;
+}
+
+segment_tree_t* segtree_wal_recover(const char *log_path, const char *snapshot_path,
+                                    segtree_wal_sync_t sync, int group_records, long long checkpoint_records) {
+    if (log_path == NULL || snapshot_path == NULL || group_records <= 0 || checkpoint_records < 0) {
+        return NULL;
+    }
+
+    uint64_t lsn = 0;
+    segment_tree_t *st = load_snapshot(snapshot_path, &lsn);
+    if (st == NULL) {
+        return NULL;
+    }
+
+    struct segtree_wal *wal = wal_open(log_path, snapshot_path, sync, group_records, checkpoint_records);
+    int fd = open(log_path, O_RDONLY);
+    replay_run_t run;
+    run.count = 0;
+    run.a = (int*)malloc((size_t)group_records * sizeof(int));
+    run.b = (int*)malloc((size_t)group_records * sizeof(int));
+    run.values = (int*)malloc((size_t)group_records * sizeof(int));
+
+    bool ok = (wal != NULL && fd >= 0 && run.a != NULL && run.b != NULL && run.values != NULL);
+    off_t valid_bytes = 0;
+    long long replayed = 0;
+
+    /* Same-kind runs are replayed through the batched entry points; a torn
+     * or out-of-sequence record ends the log. */
+    wal_record_t record;
+    while (ok && read_all(fd, &record, sizeof(record))) {
+        if (record.checksum != record_checksum(&record) || record.op < SEGTREE_WAL_POINT ||
+            record.op > SEGTREE_WAL_APPEND || (record.lsn > lsn && record.lsn != lsn + 1)) {
+            break;
+        }
+
+        valid_bytes += (off_t)sizeof(record);
+        if (record.lsn <= lsn) {
+            continue;
+        }
+        lsn = record.lsn;
+
+        if (run.count == group_records || (run.count > 0 && run.op != (segtree_wal_op_t)record.op)) {
+            ok = (replay_run(st, &run) == SEGTREE_OK);
+        }
+
+        run.op = (segtree_wal_op_t)record.op;
+        run.a[run.count] = record.a;
+        run.b[run.count] = record.b;
+        run.values[run.count] = record.value;
+        run.count++;
+        replayed++;
+    }
+
+    ok = ok && replay_run(st, &run) == SEGTREE_OK;
+    ok = ok && ftruncate(wal->fd, valid_bytes) == 0 && fsync(wal->fd) == 0;
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    free(run.a);
+    free(run.b);
+    free(run.values);
+
+    if (!ok) {
+        if (wal != NULL) {
+            wal_free(wal);
+        }
+        segtree_destroy(st);
+        return NULL;
+    }
+
+    wal->next_lsn = lsn + 1;
+    wal->since_checkpoint = replayed;
+    if (start_flusher(wal) != SEGTREE_OK) {
+        wal_free(wal);
+        segtree_destroy(st);
+        return NULL;
+    }
+    st->wal = wal;
+    segtree_reset_stats(st);
+
+    return st;
+}
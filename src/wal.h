@@ -0,0 +1,16 @@
+#ifndef SEGTREE_WAL_H
+#define SEGTREE_WAL_H
+
+#include "../include/segment_tree.h"
+
+/* Library-internal: the mutation paths log through here before applying. */
+typedef enum {
+    SEGTREE_WAL_POINT,
+    SEGTREE_WAL_RANGE,
+    SEGTREE_WAL_APPEND
+} segtree_wal_op_t;
+
+segtree_error_t segtree_wal_log(segment_tree_t *st, segtree_wal_op_t op,
+                                const int *a, const int *b, const int *values, int count);
+
+#endif
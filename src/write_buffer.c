@@ -0,0 +1,266 @@
+#include "wal.h"
+#include "write_buffer.h"
+
+static inline int buffer_find_slot(const segtree_write_buffer_t *wb, int index) {
+    unsigned int h = ((unsigned int)index * 0x9e3779b1u) & wb->slot_mask;
+    while (wb->slots[h] != -1 && wb->point_indices[wb->slots[h]] != index) {
+        h = (h + 1) & wb->slot_mask;
+    }
+    return (int)h;
+}
+
+static void buffer_clear_points(segtree_write_buffer_t *wb) {
+    /* Newest first, so every probe chain is intact when it is walked. */
+    for (int i = wb->point_count - 1; i >= 0; i--) {
+        wb->slots[buffer_find_slot(wb, wb->point_indices[i])] = -1;
+    }
+    wb->point_count = 0;
+}
+
+static void buffer_clear(segtree_write_buffer_t *wb) {
+    buffer_clear_points(wb);
+    wb->range_count = 0;
+}
+
+static void buffer_free(segtree_write_buffer_t *wb) {
+    free(wb->point_indices);
+    free(wb->point_values);
+    free(wb->slots);
+    free(wb->range_lefts);
+    free(wb->range_rights);
+    free(wb->range_values);
+    free(wb);
+}
+
+segtree_error_t segtree_write_buffer_enable(segment_tree_t *st, int limit) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (limit <= 0 || limit > SEGTREE_MAX_SIZE) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    segtree_write_buffer_t *wb = (segtree_write_buffer_t*)calloc(1, sizeof(segtree_write_buffer_t));
+    if (wb == NULL) {
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    int table_size = 1;
+    while (table_size < 2 * limit) {
+        table_size *= 2;
+    }
+
+    wb->point_indices = (int*)malloc(limit * sizeof(int));
+    wb->point_values = (int*)malloc(limit * sizeof(int));
+    wb->slots = (int*)malloc(table_size * sizeof(int));
+    wb->range_lefts = (int*)malloc(limit * sizeof(int));
+    wb->range_rights = (int*)malloc(limit * sizeof(int));
+    wb->range_values = (int*)malloc(limit * sizeof(int));
+
+    if (wb->point_indices == NULL || wb->point_values == NULL || wb->slots == NULL ||
+        wb->range_lefts == NULL || wb->range_rights == NULL || wb->range_values == NULL) {
+        buffer_free(wb);
+        return SEGTREE_ERROR_MEMORY_ALLOCATION;
+    }
+
+    for (int i = 0; i < table_size; i++) {
+        wb->slots[i] = -1;
+    }
+    wb->slot_mask = table_size - 1;
+    wb->limit = limit;
+
+    segtree_error_t error = segtree_write_buffer_disable(st);
+    if (error != SEGTREE_OK) {
+        buffer_free(wb);
+        return error;
+    }
+    st->write_buffer = wb;
+
+    return SEGTREE_OK;
+}
+
+/* A buffer that fails to flush stays enabled with its writes intact. */
+segtree_error_t segtree_write_buffer_disable(segment_tree_t *st) {
+    if (st == NULL || st->write_buffer == NULL) {
+        return SEGTREE_OK;
+    }
+
+    segtree_error_t error = segtree_flush(st);
+    if (error != SEGTREE_OK) {
+        return error;
+    }
+
+    buffer_free(st->write_buffer);
+    st->write_buffer = NULL;
+    return SEGTREE_OK;
+}
+
+void segtree_write_buffer_drop(segment_tree_t *st) {
+    if (st == NULL || st->write_buffer == NULL) {
+        return;
+    }
+
+    buffer_clear(st->write_buffer);
+}
+
+void segtree_write_buffer_discard(segment_tree_t *st) {
+    if (st == NULL || st->write_buffer == NULL) {
+        return;
+    }
+
+    buffer_clear(st->write_buffer);
+
+    /* The discarded writes are already logged; a checkpoint keeps replay
+     * from bringing them back. */
+    if (st->wal != NULL) {
+        segtree_wal_checkpoint(st);
+    }
+}
+
+segtree_error_t segtree_write_buffer_add_point(segment_tree_t *st, int index, int value) {
+    if (st == NULL || st->write_buffer == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (index < 0 || index >= st->size) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    if (st->frequency_mode && value < 0) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    segtree_write_buffer_t *wb = st->write_buffer;
+
+    /* Point writes are applied before range adds on flush, so a write that
+     * follows a buffered range add has to wait for that add to land. A
+     * buffer left full by a failed flush takes nothing until it drains. */
+    if (wb->range_count > 0 || wb->point_count >= wb->limit) {
+        segtree_error_t error = segtree_flush(st);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    /* Logged on acceptance, so a buffered write is as durable as a direct one. */
+    if (st->wal != NULL) {
+        segtree_error_t error = segtree_wal_log(st, SEGTREE_WAL_POINT, &index, NULL, &value, 1);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    int slot = buffer_find_slot(wb, index);
+    if (wb->slots[slot] != -1) {
+        wb->point_values[wb->slots[slot]] = value;
+        st->stats.coalesced_writes++;
+    } else {
+        wb->slots[slot] = wb->point_count;
+        wb->point_indices[wb->point_count] = index;
+        wb->point_values[wb->point_count] = value;
+        wb->point_count++;
+    }
+
+    st->stats.update_count++;
+
+    if (wb->point_count + wb->range_count >= wb->limit) {
+        return segtree_flush(st);
+    }
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_write_buffer_add_range(segment_tree_t *st, int left, int right, int value) {
+    if (st == NULL || st->write_buffer == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    if (!st->lazy_enabled || st->op_type != SEGTREE_SUM) {
+        return SEGTREE_ERROR_INVALID_OPERATION;
+    }
+
+    if (left < 0 || right >= st->size || left > right) {
+        return SEGTREE_ERROR_INVALID_RANGE;
+    }
+
+    segtree_write_buffer_t *wb = st->write_buffer;
+
+    /* A decrement is checked against the tree with nothing left pending. */
+    if ((st->frequency_mode && value < 0) || wb->point_count + wb->range_count >= wb->limit) {
+        segtree_error_t error = segtree_flush(st);
+        if (error == SEGTREE_OK) {
+            error = segtree_frequency_check(st, &left, &right, &value, 1);
+        }
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    if (st->wal != NULL) {
+        segtree_error_t error = segtree_wal_log(st, SEGTREE_WAL_RANGE, &left, &right, &value, 1);
+        if (error != SEGTREE_OK) {
+            return error;
+        }
+    }
+
+    int last = wb->range_count - 1;
+
+    if (last >= 0 && wb->range_lefts[last] == left && wb->range_rights[last] == right) {
+        wb->range_values[last] += value;
+        st->stats.coalesced_writes++;
+    } else {
+        wb->range_lefts[wb->range_count] = left;
+        wb->range_rights[wb->range_count] = right;
+        wb->range_values[wb->range_count] = value;
+        wb->range_count++;
+    }
+
+    st->stats.update_count++;
+
+    if (wb->point_count + wb->range_count >= wb->limit) {
+        return segtree_flush(st);
+    }
+
+    return SEGTREE_OK;
+}
+
+segtree_error_t segtree_flush(segment_tree_t *st) {
+    if (st == NULL) {
+        return SEGTREE_ERROR_NULL_POINTER;
+    }
+
+    segtree_write_buffer_t *wb = st->write_buffer;
+    if (wb == NULL || (wb->point_count == 0 && wb->range_count == 0)) {
+        return SEGTREE_OK;
+    }
+
+    /* Detach the buffer so the bulk paths below apply directly, and the log
+     * since every buffered write was logged when it was accepted. Keep the
+     * update count from being charged a second time. */
+    struct segtree_wal *wal = st->wal;
+    st->write_buffer = NULL;
+    st->wal = NULL;
+    unsigned long long update_count = st->stats.update_count;
+
+    /* Whatever fails to apply stays buffered for the next flush. Point
+     * writes are idempotent, so they are dropped only once they land. */
+    segtree_error_t error = segtree_update_points(st, wb->point_indices, wb->point_values, wb->point_count);
+    if (error == SEGTREE_OK) {
+        buffer_clear_points(wb);
+        if (wb->range_count > 0) {
+            error = segtree_update_ranges(st, wb->range_lefts, wb->range_rights, wb->range_values,
+                                          wb->range_count, NULL);
+        }
+    }
+    if (error == SEGTREE_OK) {
+        wb->range_count = 0;
+        st->stats.buffer_flushes++;
+    }
+
+    st->stats.update_count = update_count;
+    st->write_buffer = wb;
+    st->wal = wal;
+
+    return error;
+}
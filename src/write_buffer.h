@@ -0,0 +1,11 @@
+#ifndef SEGTREE_WRITE_BUFFER_H
+#define SEGTREE_WRITE_BUFFER_H
+
+#include "../include/segment_tree.h"
+
+/* Library-internal: drops pending writes without the checkpoint that
+ * segtree_write_buffer_discard() takes, for callers that replace the
+ * contents or free the tree anyway. */
+void segtree_write_buffer_drop(segment_tree_t *st);
+
+#endif
@@ -0,0 +1,106 @@
+#include "../include/segtree_2d.h"
+#include <assert.h>
+
+static int brute_rect(int *grid, int cols, segtree_operation_t op,
+                      int row1, int col1, int row2, int col2) {
+    int result = grid[row1 * cols + col1];
+    for (int r = row1; r <= row2; r++) {
+        for (int c = col1; c <= col2; c++) {
+            if (r == row1 && c == col1) {
+                continue;
+            }
+            int v = grid[r * cols + c];
+            if (op == SEGTREE_SUM) {
+                result += v;
+            } else if (op == SEGTREE_MIN) {
+                result = v < result ? v : result;
+            } else {
+                result = v > result ? v : result;
+            }
+        }
+    }
+    return result;
+}
+
+void test_2d_small() {
+    printf("Testing 2D sum on a small grid...\n");
+
+    int grid[] = {
+        1, 2, 3,
+        4, 5, 6
+    };
+
+    segtree_2d_t *st = segtree_2d_create(grid, 2, 3, SEGTREE_SUM);
+    assert(st != NULL);
+
+    int result;
+    assert(segtree_2d_query(st, 0, 0, 1, 2, &result) == SEGTREE_OK);
+    assert(result == 21);
+    assert(segtree_2d_query(st, 1, 1, 1, 2, &result) == SEGTREE_OK);
+    assert(result == 11);
+    assert(segtree_2d_query(st, 0, 2, 1, 2, &result) == SEGTREE_OK);
+    assert(result == 9);
+
+    assert(segtree_2d_update_point(st, 0, 1, 20) == SEGTREE_OK);
+    assert(segtree_2d_query(st, 0, 0, 1, 2, &result) == SEGTREE_OK);
+    assert(result == 39);
+
+    assert(segtree_2d_query(st, 0, 0, 2, 2, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_2d_query(st, 1, 0, 0, 2, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_2d_query(st, 0, 0, 1, 2, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_2d_update_point(st, 0, 3, 1) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_2d_create(grid, 2, 3, SEGTREE_CUSTOM) == NULL);
+
+    segtree_2d_destroy(st);
+    printf("2D small grid test passed!\n\n");
+}
+
+void test_2d_randomized() {
+    printf("Testing 2D min/max/sum against brute force...\n");
+
+    int rows = 13;
+    int cols = 21;
+    int grid[13 * 21];
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+
+    for (int o = 0; o < 3; o++) {
+        srand(11 + o);
+        for (int i = 0; i < rows * cols; i++) {
+            grid[i] = rand() % 200 - 100;
+        }
+
+        segtree_2d_t *st = segtree_2d_create(grid, rows, cols, ops[o]);
+        assert(st != NULL);
+
+        for (int step = 0; step < 500; step++) {
+            int r1 = rand() % rows;
+            int r2 = r1 + rand() % (rows - r1);
+            int c1 = rand() % cols;
+            int c2 = c1 + rand() % (cols - c1);
+
+            if (step % 3 == 0) {
+                int value = rand() % 200 - 100;
+                assert(segtree_2d_update_point(st, r1, c1, value) == SEGTREE_OK);
+                grid[r1 * cols + c1] = value;
+            } else {
+                int result;
+                assert(segtree_2d_query(st, r1, c1, r2, c2, &result) == SEGTREE_OK);
+                assert(result == brute_rect(grid, cols, ops[o], r1, c1, r2, c2));
+            }
+        }
+
+        segtree_2d_destroy(st);
+    }
+
+    printf("2D randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting 2D Segment Tree Tests ===\n\n");
+
+    test_2d_small();
+    test_2d_randomized();
+
+    printf("=== All 2D Segment Tree Tests Passed! ===\n");
+    return 0;
+}
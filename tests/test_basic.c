@@ -206,6 +206,372 @@ void test_custom_operations() {
     printf("Custom operations test passed!\n\n");
 }
 
+void test_query_batch() {
+    printf("Testing batched queries...\n");
+
+    int n = 1000;
+    int count = 300;
+    int *arr = (int*)malloc(n * sizeof(int));
+    int *lefts = (int*)malloc(count * sizeof(int));
+    int *rights = (int*)malloc(count * sizeof(int));
+    int *results = (int*)malloc(count * sizeof(int));
+
+    srand(99);
+    for (int i = 0; i < n; i++) {
+        arr[i] = rand() % 1000 - 500;
+    }
+    for (int i = 0; i < count; i++) {
+        lefts[i] = rand() % n;
+        rights[i] = lefts[i] + rand() % (n - lefts[i]);
+    }
+    lefts[0] = 0;
+    rights[0] = n - 1;
+    lefts[1] = 17;
+    rights[1] = 17;
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    for (int o = 0; o < 3; o++) {
+        segment_tree_t *st = segtree_create(arr, n, ops[o]);
+        assert(st != NULL);
+
+        assert(segtree_query_batch(st, lefts, rights, results, count) == SEGTREE_OK);
+
+        for (int i = 0; i < count; i++) {
+            int expected;
+            assert(segtree_query(st, lefts[i], rights[i], &expected) == SEGTREE_OK);
+            assert(results[i] == expected);
+        }
+
+        segtree_destroy(st);
+    }
+
+    segment_tree_t *st = segtree_create_lazy(arr, n, SEGTREE_SUM);
+    assert(st != NULL);
+    assert(segtree_update_range(st, 100, 700, 3) == SEGTREE_OK);
+    assert(segtree_query_batch(st, lefts, rights, results, count) == SEGTREE_OK);
+    for (int i = 0; i < count; i++) {
+        int expected;
+        assert(segtree_query(st, lefts[i], rights[i], &expected) == SEGTREE_OK);
+        assert(results[i] == expected);
+    }
+
+    assert(segtree_query_batch(st, lefts, rights, results, 0) == SEGTREE_OK);
+    assert(segtree_query_batch(st, NULL, rights, results, count) == SEGTREE_ERROR_NULL_POINTER);
+    rights[5] = n;
+    assert(segtree_query_batch(st, lefts, rights, results, count) == SEGTREE_ERROR_INVALID_RANGE);
+
+    segtree_destroy(st);
+    free(arr);
+    free(lefts);
+    free(rights);
+    free(results);
+    printf("Batched query test passed!\n\n");
+}
+
+void test_query_offline() {
+    printf("Testing offline queries...\n");
+
+    int n = 1000;
+    int count = 2000;
+    int *arr = (int*)malloc(n * sizeof(int));
+    segtree_range_t *ranges = (segtree_range_t*)malloc(count * sizeof(segtree_range_t));
+    int *results = (int*)malloc(count * sizeof(int));
+
+    srand(123);
+    for (int i = 0; i < n; i++) {
+        arr[i] = rand() % 50 - 25;
+    }
+    for (int i = 0; i < count; i++) {
+        ranges[i].left = rand() % n;
+        ranges[i].right = ranges[i].left + rand() % (n - ranges[i].left);
+    }
+    ranges[0].left = 0;
+    ranges[0].right = n - 1;
+    ranges[1].left = 42;
+    ranges[1].right = 42;
+
+    /* Large count takes the sweep; count 3 takes the per-query walk. */
+    int counts[] = {count, 3};
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    for (int o = 0; o < 3; o++) {
+        for (int lazy = 0; lazy < 2; lazy++) {
+            segment_tree_t *st = lazy ? segtree_create_lazy(arr, n, ops[o]) : segtree_create(arr, n, ops[o]);
+            assert(st != NULL);
+            if (lazy) {
+                assert(segtree_update_range(st, 100, 700, 7) == SEGTREE_OK);
+                assert(segtree_update_range(st, 650, 999, -3) == SEGTREE_OK);
+            }
+
+            for (int c = 0; c < 2; c++) {
+                assert(segtree_query_offline(st, ranges, results, counts[c]) == SEGTREE_OK);
+                for (int i = 0; i < counts[c]; i++) {
+                    int expected;
+                    assert(segtree_query(st, ranges[i].left, ranges[i].right, &expected) == SEGTREE_OK);
+                    assert(results[i] == expected);
+                }
+            }
+            assert(segtree_validate(st));
+            segtree_destroy(st);
+        }
+    }
+
+    segment_tree_t *st = segtree_create(arr, n, SEGTREE_SUM);
+    assert(segtree_query_offline(st, ranges, results, 0) == SEGTREE_OK);
+    assert(segtree_query_offline(st, NULL, results, count) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_query_offline(st, ranges, results, -1) == SEGTREE_ERROR_INVALID_RANGE);
+    ranges[7].right = n;
+    assert(segtree_query_offline(st, ranges, results, count) == SEGTREE_ERROR_INVALID_RANGE);
+    segtree_destroy(st);
+
+    free(arr);
+    free(ranges);
+    free(results);
+    printf("Offline query test passed!\n\n");
+}
+
+void test_query_arg() {
+    printf("Testing argmin/argmax queries...\n");
+
+    int n = 500;
+    int arr[500];
+    int current[500];
+    srand(48);
+    for (int i = 0; i < n; i++) {
+        arr[i] = rand() % 20;
+    }
+
+    segtree_operation_t ops[] = {SEGTREE_MIN, SEGTREE_MAX};
+    for (int o = 0; o < 2; o++) {
+        for (int lazy = 0; lazy < 2; lazy++) {
+            segment_tree_t *st = lazy ? segtree_create_lazy(arr, n, ops[o]) : segtree_create(arr, n, ops[o]);
+            assert(st != NULL);
+            memcpy(current, arr, sizeof(arr));
+
+            for (int step = 0; step < 2000; step++) {
+                int left = rand() % n;
+                int right = left + rand() % (n - left);
+
+                if (step % 4 == 0) {
+                    int value = rand() % 20;
+                    if (lazy) {
+                        assert(segtree_update_range(st, left, right, value) == SEGTREE_OK);
+                        for (int i = left; i <= right; i++) {
+                            current[i] = value;
+                        }
+                    } else {
+                        assert(segtree_update_point(st, left, value) == SEGTREE_OK);
+                        current[left] = value;
+                    }
+                    continue;
+                }
+
+                int first = left;
+                int last = left;
+                for (int i = left + 1; i <= right; i++) {
+                    bool better = (ops[o] == SEGTREE_MIN) ? current[i] < current[first] : current[i] > current[first];
+                    if (better) {
+                        first = i;
+                        last = i;
+                    } else if (current[i] == current[first]) {
+                        last = i;
+                    }
+                }
+
+                int value, index;
+                assert(segtree_query_arg(st, left, right, &value, &index, SEGTREE_TIE_LEFTMOST) == SEGTREE_OK);
+                assert(value == current[first] && index == first);
+                assert(segtree_query_arg(st, left, right, &value, &index, SEGTREE_TIE_RIGHTMOST) == SEGTREE_OK);
+                assert(value == current[last] && index == last);
+            }
+
+            assert(segtree_validate(st));
+            segtree_destroy(st);
+        }
+    }
+
+    segment_tree_t *st = segtree_create(arr, n, SEGTREE_SUM);
+    int value, index;
+    assert(segtree_query_arg(st, 0, 1, &value, &index, SEGTREE_TIE_LEFTMOST) == SEGTREE_ERROR_INVALID_OPERATION);
+    segtree_destroy(st);
+
+    st = segtree_create(arr, n, SEGTREE_MIN);
+    assert(segtree_query_arg(st, 0, 1, NULL, &index, SEGTREE_TIE_LEFTMOST) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_query_arg(st, 3, n, &value, &index, SEGTREE_TIE_LEFTMOST) == SEGTREE_ERROR_INVALID_RANGE);
+    segtree_destroy(st);
+
+    printf("Argmin/argmax query test passed!\n\n");
+}
+
+void test_order_statistics() {
+    printf("Testing k-th element and rank queries...\n");
+
+    int n = 300;
+    int counts[300];
+    int current[300];
+    srand(49);
+    for (int i = 0; i < n; i++) {
+        counts[i] = (rand() % 3 == 0) ? 0 : rand() % 5;
+    }
+
+    int *ks = (int*)malloc(4000 * sizeof(int));
+    int *answers = (int*)malloc(4000 * sizeof(int));
+    int xs[302];
+    int ranks[302];
+
+    for (int lazy = 0; lazy < 2; lazy++) {
+        segment_tree_t *st = lazy ? segtree_create_lazy(counts, n, SEGTREE_SUM) : segtree_create(counts, n, SEGTREE_SUM);
+        assert(st != NULL);
+        assert(segtree_set_frequency_mode(st, true) == SEGTREE_OK);
+        memcpy(current, counts, sizeof(counts));
+
+        if (lazy) {
+            assert(segtree_update_range(st, 40, 250, 2) == SEGTREE_OK);
+            assert(segtree_update_range(st, 100, 120, 1) == SEGTREE_OK);
+            for (int i = 40; i <= 250; i++) {
+                current[i] += (i >= 100 && i <= 120) ? 3 : 2;
+            }
+        }
+
+        int total = 0;
+        for (int i = 0; i < n; i++) {
+            total += current[i];
+        }
+
+        /* Batch keys in scrambled order, with duplicates. */
+        int k_count = 0;
+        for (int k = 1, bucket = 0, seen = 0; k <= total; k++) {
+            while (seen + current[bucket] < k) {
+                seen += current[bucket++];
+            }
+            int index;
+            assert(segtree_kth(st, k, &index) == SEGTREE_OK);
+            assert(index == bucket);
+            ks[k_count++] = k;
+        }
+        for (int i = 0; i < k_count; i++) {
+            int j = rand() % k_count;
+            int temp = ks[i];
+            ks[i] = ks[j];
+            ks[j] = temp;
+        }
+        ks[1] = ks[0];
+        assert(segtree_kth_batch(st, ks, answers, k_count) == SEGTREE_OK);
+        for (int i = 0; i < k_count; i++) {
+            int index;
+            assert(segtree_kth(st, ks[i], &index) == SEGTREE_OK);
+            assert(answers[i] == index);
+        }
+
+        int prefix = 0;
+        for (int x = 0; x <= n; x++) {
+            int count;
+            assert(segtree_rank(st, x, &count) == SEGTREE_OK);
+            assert(count == prefix);
+            xs[n - x] = x;
+            if (x < n) {
+                prefix += current[x];
+            }
+        }
+        xs[n + 1] = n;
+        assert(segtree_rank_batch(st, xs, ranks, n + 2) == SEGTREE_OK);
+        for (int i = 0; i < n + 2; i++) {
+            int count;
+            assert(segtree_rank(st, xs[i], &count) == SEGTREE_OK);
+            assert(ranks[i] == count);
+        }
+
+        int index, count;
+        assert(segtree_kth(st, 0, &index) == SEGTREE_ERROR_INVALID_RANGE);
+        assert(segtree_kth(st, total + 1, &index) == SEGTREE_ERROR_INVALID_RANGE);
+        assert(segtree_rank(st, n + 1, &count) == SEGTREE_ERROR_INVALID_RANGE);
+        assert(segtree_kth_batch(st, ks, answers, 0) == SEGTREE_OK);
+        assert(segtree_validate(st));
+        segtree_destroy(st);
+    }
+
+    /* size == capacity: rank(size) must not walk past the last leaf. */
+    int full[4] = {1, 0, 2, 1};
+    segment_tree_t *st = segtree_create(full, 4, SEGTREE_SUM);
+    int count, index;
+    assert(segtree_kth(st, 1, &index) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_set_frequency_mode(st, true) == SEGTREE_OK);
+    assert(segtree_rank(st, 4, &count) == SEGTREE_OK && count == 4);
+    assert(segtree_kth(st, 4, &index) == SEGTREE_OK && index == 3);
+    assert(segtree_kth(st, 2, &index) == SEGTREE_OK && index == 2);
+    segtree_destroy(st);
+
+    st = segtree_create(full, 4, SEGTREE_MIN);
+    assert(segtree_set_frequency_mode(st, true) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_kth(st, 1, &index) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_rank(st, 1, &count) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_kth(st, 1, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    segtree_destroy(st);
+
+    free(ks);
+    free(answers);
+    printf("Order statistics test passed!\n\n");
+}
+
+void test_frequency_mode() {
+    printf("Testing frequency mode rejects negative counts...\n");
+
+    int counts[8] = {2, 0, 1, 3, 0, 0, 4, 1};
+    int negative[8] = {2, 0, -1, 3, 0, 0, 4, 1};
+
+    segment_tree_t *bad = segtree_create(negative, 8, SEGTREE_SUM);
+    assert(segtree_set_frequency_mode(bad, true) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(!bad->frequency_mode);
+    segtree_destroy(bad);
+
+    for (int buffered = 0; buffered < 2; buffered++) {
+        segment_tree_t *st = segtree_create_lazy(counts, 8, SEGTREE_SUM);
+        assert(segtree_set_frequency_mode(st, true) == SEGTREE_OK);
+        if (buffered) {
+            assert(segtree_write_buffer_enable(st, 16) == SEGTREE_OK);
+        }
+
+        /* Pending tags count too: the add leaves 2 1 2 4 1 1 5 2. */
+        assert(segtree_update_range(st, 1, 7, 1) == SEGTREE_OK);
+        assert(segtree_update_point(st, 0, -1) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_update_range(st, 1, 3, -2) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_update_range(st, 3, 3, -3) == SEGTREE_OK);
+
+        int lefts[2] = {2, 4};
+        int rights[2] = {6, 5};
+        int values[2] = {-1, -1};
+        assert(segtree_update_ranges(st, lefts, rights, values, 2, NULL) == SEGTREE_ERROR_INVALID_OPERATION);
+        values[1] = 0;
+        assert(segtree_update_ranges(st, lefts, rights, values, 2, NULL) == SEGTREE_OK);
+
+        int indices[2] = {1, 2};
+        int points[2] = {5, -3};
+        assert(segtree_update_points(st, indices, points, 2) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_append(st, -1) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_rebuild(st, negative, 8) == SEGTREE_ERROR_INVALID_OPERATION);
+
+        /* Counts are now 2 1 1 0 0 0 4 2: nothing rejected reached the tree. */
+        int expected[8] = {2, 1, 1, 0, 0, 0, 4, 2};
+        for (int i = 0; i < 8; i++) {
+            int value;
+            assert(segtree_query(st, i, i, &value) == SEGTREE_OK);
+            assert(value == expected[i]);
+        }
+
+        int index;
+        assert(segtree_kth(st, 5, &index) == SEGTREE_OK && index == 6);
+
+        /* Leaving the mode lifts the restriction and disables kth/rank. */
+        assert(segtree_set_frequency_mode(st, false) == SEGTREE_OK);
+        assert(segtree_update_point(st, 0, -1) == SEGTREE_OK);
+        assert(segtree_kth(st, 1, &index) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_set_frequency_mode(st, true) == SEGTREE_ERROR_INVALID_OPERATION);
+        assert(segtree_validate(st));
+        segtree_destroy(st);
+    }
+
+    printf("Frequency mode test passed!\n\n");
+}
+
 int main() {
     printf("=== Starting Basic Tests ===\n\n");
 
@@ -215,6 +581,11 @@ int main() {
     test_max_operations();
     test_error_handling();
     test_custom_operations();
+    test_query_batch();
+    test_query_offline();
+    test_query_arg();
+    test_order_statistics();
+    test_frequency_mode();
 
     printf("=== All Basic Tests Passed! ===\n");
     return 0;
@@ -0,0 +1,159 @@
+#include "../include/segtree_beats.h"
+#include <assert.h>
+#include <limits.h>
+
+void test_beats_basic() {
+    printf("Testing beats chmin/chmax/add...\n");
+
+    int arr[] = {5, 1, 8, 3, 7};
+    segtree_beats_t *bt = segtree_beats_create(arr, 5);
+    assert(bt != NULL);
+
+    long long sum;
+    int value;
+
+    assert(segtree_beats_chmin(bt, 0, 4, 4) == SEGTREE_OK);   /* 4 1 4 3 4 */
+    assert(segtree_beats_query_sum(bt, 0, 4, &sum) == SEGTREE_OK);
+    assert(sum == 16);
+
+    assert(segtree_beats_chmax(bt, 1, 3, 3) == SEGTREE_OK);   /* 4 3 4 3 4 */
+    assert(segtree_beats_query_min(bt, 0, 4, &value) == SEGTREE_OK);
+    assert(value == 3);
+
+    assert(segtree_beats_add(bt, 2, 4, 10) == SEGTREE_OK);    /* 4 3 14 13 14 */
+    assert(segtree_beats_query_max(bt, 0, 4, &value) == SEGTREE_OK);
+    assert(value == 14);
+    assert(segtree_beats_query_sum(bt, 1, 3, &sum) == SEGTREE_OK);
+    assert(sum == 30);
+
+    assert(segtree_beats_chmin(bt, 0, 5, 1) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_beats_query_sum(bt, 0, 4, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_beats_add(NULL, 0, 0, 1) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_beats_destroy(bt);
+    printf("Beats basic test passed!\n\n");
+}
+
+void test_beats_int_limits() {
+    printf("Testing beats at INT_MIN/INT_MAX...\n");
+
+    int arr[] = {5, 3, 7, 1};
+    segtree_beats_t *bt = segtree_beats_create(arr, 4);
+    assert(bt != NULL);
+
+    long long sum;
+    int value;
+
+    assert(segtree_beats_chmin(bt, 0, 3, INT_MIN) == SEGTREE_OK);
+    assert(segtree_beats_query_sum(bt, 0, 3, &sum) == SEGTREE_OK);
+    assert(sum == 4LL * INT_MIN);
+    assert(segtree_beats_query_max(bt, 0, 3, &value) == SEGTREE_OK);
+    assert(value == INT_MIN);
+
+    assert(segtree_beats_chmax(bt, 0, 3, INT_MAX) == SEGTREE_OK);
+    assert(segtree_beats_query_sum(bt, 0, 3, &sum) == SEGTREE_OK);
+    assert(sum == 4LL * INT_MAX);
+    assert(segtree_beats_query_min(bt, 0, 3, &value) == SEGTREE_OK);
+    assert(value == INT_MAX);
+    segtree_beats_destroy(bt);
+
+    /* Extremes mixed with ordinary values keep a real second extreme. */
+    bt = segtree_beats_create(arr, 4);
+    assert(bt != NULL);
+    assert(segtree_beats_chmin(bt, 1, 2, INT_MIN) == SEGTREE_OK);   /* 5 MIN MIN 1 */
+    assert(segtree_beats_chmax(bt, 0, 0, INT_MAX) == SEGTREE_OK);   /* MAX MIN MIN 1 */
+    assert(segtree_beats_chmin(bt, 0, 3, 2) == SEGTREE_OK);         /* 2 MIN MIN 1 */
+    assert(segtree_beats_query_sum(bt, 0, 3, &sum) == SEGTREE_OK);
+    assert(sum == 3LL + 2LL * INT_MIN);
+    assert(segtree_beats_chmax(bt, 0, 3, INT_MIN) == SEGTREE_OK);
+    assert(segtree_beats_chmax(bt, 1, 3, 0) == SEGTREE_OK);         /* 2 0 0 1 */
+    assert(segtree_beats_query_sum(bt, 0, 3, &sum) == SEGTREE_OK);
+    assert(sum == 3);
+    assert(segtree_beats_query_min(bt, 0, 3, &value) == SEGTREE_OK);
+    assert(value == 0);
+    segtree_beats_destroy(bt);
+
+    printf("Beats INT_MIN/INT_MAX test passed!\n\n");
+}
+
+void test_beats_randomized() {
+    printf("Testing beats against a naive array...\n");
+
+    int sizes[] = {1, 2, 17, 128, 301};
+    int arr[301];
+    int naive[301];
+
+    srand(36);
+    for (int s = 0; s < 5; s++) {
+        int n = sizes[s];
+        for (int i = 0; i < n; i++) {
+            arr[i] = rand() % 2001 - 1000;
+            naive[i] = arr[i];
+        }
+
+        segtree_beats_t *bt = segtree_beats_create(arr, n);
+        assert(bt != NULL);
+
+        for (int step = 0; step < 3000; step++) {
+            int left = rand() % n;
+            int right = left + rand() % (n - left);
+            int value = rand() % 2001 - 1000;
+
+            switch (rand() % 6) {
+                case 0:
+                    assert(segtree_beats_chmin(bt, left, right, value) == SEGTREE_OK);
+                    for (int i = left; i <= right; i++) {
+                        naive[i] = naive[i] < value ? naive[i] : value;
+                    }
+                    break;
+                case 1:
+                    assert(segtree_beats_chmax(bt, left, right, value) == SEGTREE_OK);
+                    for (int i = left; i <= right; i++) {
+                        naive[i] = naive[i] > value ? naive[i] : value;
+                    }
+                    break;
+                case 2:
+                    value /= 10;
+                    assert(segtree_beats_add(bt, left, right, value) == SEGTREE_OK);
+                    for (int i = left; i <= right; i++) {
+                        naive[i] += value;
+                    }
+                    break;
+                default: {
+                    long long sum;
+                    int mn, mx;
+                    long long expected_sum = 0;
+                    int expected_min = naive[left];
+                    int expected_max = naive[left];
+                    for (int i = left; i <= right; i++) {
+                        expected_sum += naive[i];
+                        expected_min = naive[i] < expected_min ? naive[i] : expected_min;
+                        expected_max = naive[i] > expected_max ? naive[i] : expected_max;
+                    }
+                    assert(segtree_beats_query_sum(bt, left, right, &sum) == SEGTREE_OK);
+                    assert(segtree_beats_query_min(bt, left, right, &mn) == SEGTREE_OK);
+                    assert(segtree_beats_query_max(bt, left, right, &mx) == SEGTREE_OK);
+                    assert(sum == expected_sum);
+                    assert(mn == expected_min);
+                    assert(mx == expected_max);
+                    break;
+                }
+            }
+        }
+
+        segtree_beats_destroy(bt);
+    }
+
+    printf("Beats randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Segment Tree Beats Tests ===\n\n");
+
+    test_beats_basic();
+    test_beats_int_limits();
+    test_beats_randomized();
+
+    printf("=== All Segment Tree Beats Tests Passed! ===\n");
+    return 0;
+}
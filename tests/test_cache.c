@@ -0,0 +1,103 @@
+#include "../include/segment_tree.h"
+#include <assert.h>
+
+void test_cache_hits_and_misses() {
+    printf("Testing range cache hits and misses...\n");
+
+    int arr[] = {5, 1, 4, 2, 8, 7, 3, 6};
+    segment_tree_t *st = segtree_create(arr, 8, SEGTREE_SUM);
+    assert(st != NULL);
+
+    assert(segtree_cache_enable(st, 100) == SEGTREE_OK);
+    assert(st->cache->mask == 127);
+
+    int result;
+    assert(segtree_query(st, 0, 7, &result) == SEGTREE_OK);
+    assert(result == 36);
+    assert(segtree_query(st, 0, 7, &result) == SEGTREE_OK);
+    assert(result == 36);
+    assert(segtree_query(st, 2, 5, &result) == SEGTREE_OK);
+    assert(result == 21);
+
+    segtree_stats_t stats = segtree_get_stats(st);
+    assert(stats.cache_hits == 1);
+    assert(stats.cache_misses == 2);
+    assert(stats.query_count == 3);
+
+    assert(segtree_update_point(st, 4, 0) == SEGTREE_OK);
+    assert(segtree_query(st, 0, 7, &result) == SEGTREE_OK);
+    assert(result == 28);
+    assert(segtree_query(st, 0, 7, &result) == SEGTREE_OK);
+    assert(result == 28);
+
+    stats = segtree_get_stats(st);
+    assert(stats.cache_hits == 2);
+    assert(stats.cache_misses == 3);
+
+    segtree_destroy(st);
+    printf("Range cache hit/miss test passed!\n\n");
+}
+
+void test_cache_subtree_epochs() {
+    printf("Testing per-block invalidation...\n");
+
+    int n = 1024;
+    int *arr = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        arr[i] = i % 13;
+    }
+
+    segment_tree_t *st = segtree_create_lazy(arr, n, SEGTREE_MAX);
+    assert(st != NULL);
+    assert(segtree_cache_enable(st, 64) == SEGTREE_OK);
+
+    int result;
+    assert(segtree_query(st, 0, 99, &result) == SEGTREE_OK);
+    assert(segtree_query(st, 900, 1000, &result) == SEGTREE_OK);
+    assert(result == 12);
+
+    assert(segtree_update_range(st, 950, 960, 77) == SEGTREE_OK);
+
+    segtree_reset_stats(st);
+    assert(segtree_query(st, 0, 99, &result) == SEGTREE_OK);
+    assert(result == 12);
+    assert(segtree_query(st, 900, 1000, &result) == SEGTREE_OK);
+    assert(result == 77);
+
+    segtree_stats_t stats = segtree_get_stats(st);
+    assert(stats.cache_hits == 1);
+    assert(stats.cache_misses == 1);
+
+    assert(segtree_append(st, 500) == SEGTREE_OK);
+    assert(segtree_query(st, 0, 1024, &result) == SEGTREE_OK);
+    assert(result == 500);
+    assert(segtree_query(st, 0, 99, &result) == SEGTREE_OK);
+    assert(result == 12);
+
+    arr[10] = 40;
+    assert(segtree_rebuild(st, arr, n) == SEGTREE_OK);
+    assert(segtree_query(st, 0, 99, &result) == SEGTREE_OK);
+    assert(result == 40);
+
+    segtree_cache_disable(st);
+    assert(st->cache == NULL);
+    assert(segtree_query(st, 0, 99, &result) == SEGTREE_OK);
+    assert(result == 40);
+
+    assert(segtree_cache_enable(NULL, 8) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_cache_enable(st, 0) == SEGTREE_ERROR_INVALID_RANGE);
+
+    segtree_destroy(st);
+    free(arr);
+    printf("Per-block invalidation test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Range Cache Tests ===\n\n");
+
+    test_cache_hits_and_misses();
+    test_cache_subtree_epochs();
+
+    printf("=== All Range Cache Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include "../include/segtree_cover.h"
+#include <assert.h>
+
+void test_cover_basic() {
+    printf("Testing coverage add/remove/query...\n");
+
+    segtree_cover_t *ct = segtree_cover_create(10);
+    assert(ct != NULL);
+    assert(segtree_cover_total(ct) == 0);
+
+    long long length;
+
+    assert(segtree_cover_add(ct, 1, 4) == SEGTREE_OK);    /* [1,4) */
+    assert(segtree_cover_add(ct, 3, 7) == SEGTREE_OK);    /* [1,7) */
+    assert(segtree_cover_total(ct) == 6);
+    assert(segtree_cover_query(ct, 0, 2, &length) == SEGTREE_OK);
+    assert(length == 1);
+    assert(segtree_cover_query(ct, 5, 10, &length) == SEGTREE_OK);
+    assert(length == 2);
+
+    assert(segtree_cover_remove(ct, 1, 4) == SEGTREE_OK); /* [3,7) */
+    assert(segtree_cover_total(ct) == 4);
+    assert(segtree_cover_query(ct, 0, 4, &length) == SEGTREE_OK);
+    assert(length == 1);
+
+    /* Removing what was never added leaves the tree untouched. */
+    assert(segtree_cover_remove(ct, 1, 4) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_cover_remove(ct, 2, 5) == SEGTREE_ERROR_INVALID_OPERATION);
+    assert(segtree_cover_total(ct) == 4);
+
+    assert(segtree_cover_add(ct, 4, 4) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_cover_add(ct, -1, 3) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_cover_add(ct, 0, 11) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_cover_query(ct, 5, 4, &length) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_cover_query(ct, 0, 10, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_cover_add(NULL, 0, 1) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_cover_create(0) == NULL);
+
+    segtree_cover_destroy(ct);
+    printf("Coverage basic test passed!\n\n");
+}
+
+void test_cover_compressed() {
+    printf("Testing coverage with coordinate compression...\n");
+
+    int points[] = {1000000, -500, 20, 20, 1000000, 70, -500};
+    segtree_cover_t *ct = segtree_cover_create_compressed(points, 7);
+    assert(ct != NULL);
+    assert(ct->segments == 3);
+
+    long long length;
+
+    assert(segtree_cover_add(ct, -500, 70) == SEGTREE_OK);
+    assert(segtree_cover_add(ct, 20, 1000000) == SEGTREE_OK);
+    assert(segtree_cover_total(ct) == 1000500);
+
+    /* Query bounds need not be coordinates. */
+    assert(segtree_cover_query(ct, -1000, -400, &length) == SEGTREE_OK);
+    assert(length == 100);
+    assert(segtree_cover_query(ct, 999990, 2000000, &length) == SEGTREE_OK);
+    assert(length == 10);
+
+    assert(segtree_cover_remove(ct, -500, 70) == SEGTREE_OK);
+    assert(segtree_cover_total(ct) == 1000000 - 20);
+    assert(segtree_cover_query(ct, 0, 30, &length) == SEGTREE_OK);
+    assert(length == 10);
+
+    assert(segtree_cover_add(ct, 0, 70) == SEGTREE_ERROR_INVALID_RANGE);
+
+    int same[] = {5, 5};
+    assert(segtree_cover_create_compressed(same, 2) == NULL);
+    assert(segtree_cover_create_compressed(NULL, 2) == NULL);
+
+    segtree_cover_destroy(ct);
+    printf("Coverage compression test passed!\n\n");
+}
+
+void test_cover_randomized() {
+    printf("Testing coverage against naive counts...\n");
+
+    int points[64];
+    int n = 64;
+    int added[2000][2];
+    int live;
+
+    srand(50);
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < n; i++) {
+            points[i] = rand() % 2001 - 1000;
+        }
+
+        segtree_cover_t *ct = segtree_cover_create_compressed(points, n);
+        assert(ct != NULL);
+        int m = ct->segments;
+        int naive[64] = {0};
+        live = 0;
+
+        for (int step = 0; step < 2000; step++) {
+            int op = rand() % 3;
+
+            if (op == 0 || live == 0) {
+                int a = rand() % (m + 1);
+                int b = rand() % (m + 1);
+                if (a == b) {
+                    continue;
+                }
+                if (a > b) {
+                    int t = a; a = b; b = t;
+                }
+                assert(segtree_cover_add(ct, ct->coords[a], ct->coords[b]) == SEGTREE_OK);
+                for (int i = a; i < b; i++) {
+                    naive[i]++;
+                }
+                added[live][0] = a;
+                added[live][1] = b;
+                live++;
+            } else if (op == 1) {
+                int pick = rand() % live;
+                int a = added[pick][0];
+                int b = added[pick][1];
+                assert(segtree_cover_remove(ct, ct->coords[a], ct->coords[b]) == SEGTREE_OK);
+                for (int i = a; i < b; i++) {
+                    naive[i]--;
+                }
+                added[pick][0] = added[live - 1][0];
+                added[pick][1] = added[live - 1][1];
+                live--;
+            }
+
+            int begin = rand() % 2401 - 1200;
+            int end = begin + rand() % 1200;
+            long long expected = 0;
+            long long total = 0;
+            for (int i = 0; i < m; i++) {
+                if (naive[i] == 0) {
+                    continue;
+                }
+                long long from = ct->coords[i] > begin ? ct->coords[i] : begin;
+                long long to = ct->coords[i + 1] < end ? ct->coords[i + 1] : end;
+                if (to > from) {
+                    expected += to - from;
+                }
+                total += ct->coords[i + 1] - ct->coords[i];
+            }
+
+            long long length;
+            assert(segtree_cover_query(ct, begin, end, &length) == SEGTREE_OK);
+            assert(length == expected);
+            assert(segtree_cover_total(ct) == total);
+        }
+
+        segtree_cover_destroy(ct);
+    }
+
+    printf("Coverage randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Coverage Tree Tests ===\n\n");
+
+    test_cover_basic();
+    test_cover_compressed();
+    test_cover_randomized();
+
+    printf("=== All Coverage Tree Tests Passed! ===\n");
+    return 0;
+}
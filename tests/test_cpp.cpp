@@ -0,0 +1,119 @@
+#include "../include/segtree.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+void test_cpp_static() {
+    std::printf("Testing C++ tree with static monoids...\n");
+
+    std::vector<int> values = {5, 3, 8, 1, 9, 2};
+    segtree::tree<int> sums(values);
+    segtree::tree<int, segtree::min<int>> mins(values);
+    segtree::tree<int, segtree::max<int>> maxs{std::span<const int>(values)};
+
+    assert(sums.query(0, 5) == 28);
+    assert(sums.query(1, 3) == 12);
+    assert(mins.query(0, 5) == 1);
+    assert(maxs.query(2, 5) == 9);
+
+    sums.update_point(3, 10);
+    mins.update_point(3, 10);
+    assert(sums.query(1, 3) == 21);
+    assert(mins.query(0, 5) == 2);
+
+    segtree::tree<int> moved = std::move(sums);
+    assert(moved.query(0, 5) == 37);
+    assert(sums.size() == 0);
+
+    bool threw = false;
+    try {
+        moved.query(2, 6);
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::printf("C++ static tree test passed!\n\n");
+}
+
+template <class Tree, class Apply, class Combine>
+static void check_lazy(Tree &tree, std::vector<long long> &naive, Apply apply, Combine combine, int steps) {
+    int n = static_cast<int>(naive.size());
+    for (int step = 0; step < steps; step++) {
+        int left = std::rand() % n;
+        int right = left + std::rand() % (n - left);
+        long long value = std::rand() % 201 - 100;
+
+        switch (std::rand() % 3) {
+            case 0:
+                tree.update_range(left, right, apply(value));
+                for (int i = left; i <= right; i++) {
+                    naive[i] = combine(naive[i], value);
+                }
+                break;
+            case 1:
+                tree.update_point(left, value);
+                naive[left] = value;
+                break;
+            default:
+                break;
+        }
+
+        long long expected_sum = 0;
+        long long expected_min = naive[left];
+        for (int i = left; i <= right; i++) {
+            expected_sum += naive[i];
+            expected_min = naive[i] < expected_min ? naive[i] : expected_min;
+        }
+
+        long long result = tree.query(left, right);
+        if constexpr (std::is_same_v<Tree, segtree::tree<long long, segtree::sum<long long>,
+                                                         segtree::add_to_sum<long long>>>) {
+            assert(result == expected_sum);
+        } else {
+            assert(result == expected_min);
+        }
+    }
+}
+
+void test_cpp_lazy() {
+    std::printf("Testing C++ tree with lazy tags against a naive array...\n");
+
+    std::srand(41);
+    int sizes[] = {1, 7, 64, 100};
+    for (int n : sizes) {
+        std::vector<long long> values(n);
+        for (auto &v : values) {
+            v = std::rand() % 1001 - 500;
+        }
+
+        std::vector<long long> naive = values;
+        segtree::tree<long long, segtree::sum<long long>, segtree::add_to_sum<long long>> sums(values);
+        check_lazy(sums, naive, [](long long v) { return v; },
+                   [](long long a, long long v) { return a + v; }, 2000);
+
+        naive = values;
+        segtree::tree<long long, segtree::min<long long>, segtree::add_to_extreme<long long>> mins(values);
+        check_lazy(mins, naive, [](long long v) { return v; },
+                   [](long long a, long long v) { return a + v; }, 2000);
+
+        using assign = segtree::assign_to_extreme<long long>;
+        naive = values;
+        segtree::tree<long long, segtree::min<long long>, assign> assigned(values);
+        check_lazy(assigned, naive, [](long long v) { return assign::tag_type{v, true}; },
+                   [](long long, long long v) { return v; }, 2000);
+    }
+
+    std::printf("C++ lazy tree test passed!\n\n");
+}
+
+int main() {
+    std::printf("=== Starting C++ Front-end Tests ===\n\n");
+
+    test_cpp_static();
+    test_cpp_lazy();
+
+    std::printf("=== All C++ Front-end Tests Passed! ===\n");
+    return 0;
+}
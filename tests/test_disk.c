@@ -0,0 +1,313 @@
+#define _XOPEN_SOURCE 700
+
+#include "../include/segtree_disk.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static void temp_path(char *path) {
+    strcpy(path, "/tmp/segtree_disk_XXXXXX");
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+}
+
+typedef struct {
+    const int *arr;
+    long long pos;
+} array_reader_t;
+
+static int read_array(void *ctx, int *buf, size_t n) {
+    array_reader_t *reader = (array_reader_t*)ctx;
+    memcpy(buf, reader->arr + reader->pos, n * sizeof(int));
+    reader->pos += (long long)n;
+    return (int)n;
+}
+
+static segtree_disk_t* create_from_array(const char *path, const int *arr, long long n,
+                                         segtree_operation_t op, int resident_levels, int cache_pages) {
+    array_reader_t reader = {arr, 0};
+    return segtree_disk_create(path, read_array, &reader, n, op, resident_levels, cache_pages);
+}
+
+static long long naive_range(int *arr, long long left, long long right, segtree_operation_t op) {
+    long long result = arr[left];
+    for (long long i = left + 1; i <= right; i++) {
+        if (op == SEGTREE_SUM) {
+            result += arr[i];
+        } else if (op == SEGTREE_MIN) {
+            result = arr[i] < result ? arr[i] : result;
+        } else {
+            result = arr[i] > result ? arr[i] : result;
+        }
+    }
+    return result;
+}
+
+void test_disk_queries_and_updates() {
+    printf("Testing out-of-core queries and write-back updates...\n");
+
+    long long n = 100000;
+    int *arr = (int*)malloc(n * sizeof(int));
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    char path[64];
+
+    srand(38);
+    for (int o = 0; o < 3; o++) {
+        for (long long i = 0; i < n; i++) {
+            arr[i] = rand() % 2000001 - 1000000;
+        }
+
+        temp_path(path);
+        segtree_disk_t *dt = create_from_array(path, arr, n, ops[o], 4, 8);
+        assert(dt != NULL);
+        assert(dt->band_count == 2);
+        assert(dt->resident_levels == 4);
+
+        for (int step = 0; step < 600; step++) {
+            long long left = rand() % n;
+            long long right = left + rand() % (n - left);
+
+            if (step % 3 == 0) {
+                int value = rand() % 2000001 - 1000000;
+                assert(segtree_disk_update_point(dt, left, value) == SEGTREE_OK);
+                arr[left] = value;
+            }
+
+            long long result;
+            assert(segtree_disk_query(dt, left, right, &result) == SEGTREE_OK);
+            assert(result == naive_range(arr, left, right, ops[o]));
+        }
+
+        segtree_disk_io_t io = segtree_disk_get_io(dt);
+        assert(io.page_reads > 0);
+        assert(io.evictions > 0);
+        assert(io.cache_hits + io.cache_misses > io.page_reads);
+
+        long long result;
+        assert(segtree_disk_query(dt, 0, n, &result) == SEGTREE_ERROR_INVALID_RANGE);
+        assert(segtree_disk_query(dt, 0, 1, NULL) == SEGTREE_ERROR_NULL_POINTER);
+        assert(segtree_disk_update_point(dt, -1, 0) == SEGTREE_ERROR_INVALID_RANGE);
+
+        segtree_disk_destroy(dt);
+
+        dt = segtree_disk_open(path, 16);
+        assert(dt != NULL);
+        assert(dt->size == n);
+        for (int step = 0; step < 100; step++) {
+            long long left = rand() % n;
+            long long right = left + rand() % (n - left);
+            assert(segtree_disk_query(dt, left, right, &result) == SEGTREE_OK);
+            assert(result == naive_range(arr, left, right, ops[o]));
+        }
+        segtree_disk_destroy(dt);
+
+        unlink(path);
+    }
+
+    free(arr);
+    printf("Out-of-core query/update test passed!\n\n");
+}
+
+void test_disk_small_and_resident() {
+    printf("Testing out-of-core tree that fits in resident levels...\n");
+
+    int arr[] = {4, -2, 7, 1, 9};
+    char path[64];
+    temp_path(path);
+
+    /* More levels than the tree has are clamped to its height. */
+    segtree_disk_t *dt = create_from_array(path, arr, 5, SEGTREE_SUM, 10, 2);
+    assert(dt != NULL);
+    assert(dt->resident_levels == 4);
+    assert(dt->band_count == 0);
+
+    long long result;
+    assert(segtree_disk_query(dt, 1, 3, &result) == SEGTREE_OK);
+    assert(result == 6);
+    assert(segtree_disk_update_point(dt, 2, 0) == SEGTREE_OK);
+    assert(segtree_disk_query(dt, 0, 4, &result) == SEGTREE_OK);
+    assert(result == 12);
+    assert(segtree_disk_get_io(dt).page_reads == 0);
+
+    segtree_disk_destroy(dt);
+
+    dt = segtree_disk_open(path, 2);
+    assert(dt != NULL);
+    assert(segtree_disk_query(dt, 0, 4, &result) == SEGTREE_OK);
+    assert(result == 12);
+    segtree_disk_destroy(dt);
+
+    unlink(path);
+    assert(segtree_disk_open(path, 2) == NULL);
+    assert(create_from_array(path, arr, 5, SEGTREE_CUSTOM, 1, 2) == NULL);
+
+    printf("Out-of-core resident test passed!\n\n");
+}
+
+/* Leaves are generated on demand, so the input never exists as an array. */
+static int generated_value(long long index) {
+    return (int)((unsigned long long)index * 2654435761ULL % 2001) - 1000;
+}
+
+typedef struct {
+    long long pos;
+    long long limit;
+    size_t largest_request;
+} generator_t;
+
+static int read_generated(void *ctx, int *buf, size_t n) {
+    generator_t *gen = (generator_t*)ctx;
+    if (n > gen->largest_request) {
+        gen->largest_request = n;
+    }
+
+    size_t count = 0;
+    while (count < n && gen->pos < gen->limit) {
+        buf[count++] = generated_value(gen->pos++);
+    }
+    return (int)count;
+}
+
+void test_disk_streaming_build() {
+    printf("Testing out-of-core build from a streaming reader...\n");
+
+    long long n = 3000000;
+    char path[64];
+    temp_path(path);
+
+    /* Eight cached pages hold 4096 nodes, far fewer than n leaves. */
+    generator_t gen = {0, n, 0};
+    segtree_disk_t *dt = segtree_disk_create(path, read_generated, &gen, n, SEGTREE_SUM, 4, 8);
+    assert(dt != NULL);
+    assert(gen.pos == n);
+    assert(gen.largest_request <= SEGTREE_DISK_PAGE_NODES);
+    assert(dt->band_count == 3);
+
+    srand(380);
+    for (int step = 0; step < 20; step++) {
+        long long left = ((long long)rand() * RAND_MAX + rand()) % n;
+        long long right = left + rand() % 50000;
+        right = right < n ? right : n - 1;
+
+        long long expected = 0;
+        for (long long i = left; i <= right; i++) {
+            expected += generated_value(i);
+        }
+
+        long long result;
+        assert(segtree_disk_query(dt, left, right, &result) == SEGTREE_OK);
+        assert(result == expected);
+    }
+
+    long long total = 0;
+    for (long long i = 0; i < n; i++) {
+        total += generated_value(i);
+    }
+    long long result;
+    assert(segtree_disk_query(dt, 0, n - 1, &result) == SEGTREE_OK);
+    assert(result == total);
+    segtree_disk_destroy(dt);
+
+    /* A reader that runs dry before n leaves fails the build. */
+    generator_t short_gen = {0, n / 2, 0};
+    assert(segtree_disk_create(path, read_generated, &short_gen, n, SEGTREE_SUM, 4, 8) == NULL);
+    assert(segtree_disk_create(path, NULL, NULL, n, SEGTREE_SUM, 4, 8) == NULL);
+
+    unlink(path);
+    printf("Out-of-core streaming build test passed!\n\n");
+}
+
+void test_disk_resident_budget() {
+    printf("Testing out-of-core resident level budget...\n");
+
+    long long n = 5000;      /* depth 13, 14 levels */
+    int *arr = (int*)malloc(n * sizeof(int));
+    char path[64];
+
+    for (long long i = 0; i < n; i++) {
+        arr[i] = (int)(i % 97) - 48;
+    }
+
+    /* Every request from 1 to 14 levels, including ones off the band boundary. */
+    for (int requested = 1; requested <= 14; requested++) {
+        temp_path(path);
+        segtree_disk_t *dt = create_from_array(path, arr, n, SEGTREE_SUM, requested, 4);
+        assert(dt != NULL);
+        long long budget = (1LL << requested) * (long long)sizeof(long long);
+        assert(dt->resident_levels == requested);
+        assert((1LL << dt->resident_levels) * (long long)sizeof(long long) <= budget);
+        assert(dt->band_count == (14 - requested + SEGTREE_DISK_BAND_LEVELS - 1) / SEGTREE_DISK_BAND_LEVELS);
+
+        long long result;
+        assert(segtree_disk_query(dt, 0, n - 1, &result) == SEGTREE_OK);
+        assert(result == naive_range(arr, 0, n - 1, SEGTREE_SUM));
+        assert(segtree_disk_update_point(dt, 1234, 5000) == SEGTREE_OK);
+        assert(segtree_disk_query(dt, 1000, 2000, &result) == SEGTREE_OK);
+        assert(result == naive_range(arr, 1000, 2000, SEGTREE_SUM) - arr[1234] + 5000);
+        segtree_disk_destroy(dt);
+
+        dt = segtree_disk_open(path, 4);
+        assert(dt != NULL);
+        assert(dt->resident_levels == requested);
+        assert(segtree_disk_query(dt, 1000, 2000, &result) == SEGTREE_OK);
+        assert(result == naive_range(arr, 1000, 2000, SEGTREE_SUM) - arr[1234] + 5000);
+        segtree_disk_destroy(dt);
+
+        unlink(path);
+    }
+
+    free(arr);
+    printf("Out-of-core resident budget test passed!\n\n");
+}
+
+void test_disk_rejects_bad_header() {
+    printf("Testing out-of-core open with a corrupt operation type...\n");
+
+    int arr[] = {3, 1, 4, 1, 5, 9};
+    char path[64];
+    temp_path(path);
+
+    segtree_disk_t *dt = create_from_array(path, arr, 6, SEGTREE_MAX, 1, 2);
+    assert(dt != NULL);
+    segtree_disk_destroy(dt);
+
+    /* op_type sits after magic, size, depth and resident_levels. */
+    int fd = open(path, O_RDWR);
+    assert(fd >= 0);
+    int bogus = 7;
+    off_t offset = 8 + sizeof(long long) + 2 * sizeof(int);
+    assert(pwrite(fd, &bogus, sizeof(bogus), offset) == sizeof(bogus));
+    assert(segtree_disk_open(path, 2) == NULL);
+
+    bogus = SEGTREE_CUSTOM;
+    assert(pwrite(fd, &bogus, sizeof(bogus), offset) == sizeof(bogus));
+    assert(segtree_disk_open(path, 2) == NULL);
+
+    bogus = SEGTREE_MAX;
+    assert(pwrite(fd, &bogus, sizeof(bogus), offset) == sizeof(bogus));
+    close(fd);
+
+    dt = segtree_disk_open(path, 2);
+    assert(dt != NULL);
+    long long result;
+    assert(segtree_disk_query(dt, 0, 5, &result) == SEGTREE_OK);
+    assert(result == 9);
+    segtree_disk_destroy(dt);
+
+    unlink(path);
+    printf("Out-of-core header validation test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Out-of-Core Segment Tree Tests ===\n\n");
+
+    test_disk_queries_and_updates();
+    test_disk_small_and_resident();
+    test_disk_streaming_build();
+    test_disk_resident_budget();
+    test_disk_rejects_bad_header();
+
+    printf("=== All Out-of-Core Segment Tree Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,266 @@
+#include "../include/segment_tree.h"
+#include <assert.h>
+
+static int brute_sum(int *arr, int left, int right) {
+    int sum = 0;
+    for (int i = left; i <= right; i++) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+static int brute_min(int *arr, int left, int right) {
+    int result = arr[left];
+    for (int i = left + 1; i <= right; i++) {
+        if (arr[i] < result) {
+            result = arr[i];
+        }
+    }
+    return result;
+}
+
+void test_append_single() {
+    printf("Testing single appends...\n");
+
+    int arr[] = {4};
+    int values[64];
+    values[0] = 4;
+
+    segment_tree_t *st = segtree_create(arr, 1, SEGTREE_SUM);
+    assert(st != NULL);
+
+    int result;
+    for (int i = 1; i < 64; i++) {
+        values[i] = i * 3 - 7;
+        assert(segtree_append(st, values[i]) == SEGTREE_OK);
+        assert(st->size == i + 1);
+        assert(st->capacity >= st->size);
+        assert(segtree_validate(st));
+
+        assert(segtree_query(st, 0, i, &result) == SEGTREE_OK);
+        assert(result == brute_sum(values, 0, i));
+
+        assert(segtree_query(st, i / 2, i, &result) == SEGTREE_OK);
+        assert(result == brute_sum(values, i / 2, i));
+    }
+
+    assert(st->capacity == 64);
+
+    segtree_destroy(st);
+    printf("Single append test passed!\n\n");
+}
+
+void test_append_many() {
+    printf("Testing batched appends...\n");
+
+    int arr[] = {9, 2, 7};
+    int values[100];
+    for (int i = 0; i < 100; i++) {
+        values[i] = (i * 37) % 50 - 10;
+    }
+    values[0] = 9;
+    values[1] = 2;
+    values[2] = 7;
+
+    segment_tree_t *st = segtree_create(arr, 3, SEGTREE_MIN);
+    assert(st != NULL);
+
+    assert(segtree_append_many(st, values + 3, 10) == SEGTREE_OK);
+    assert(segtree_append_many(st, values + 13, 87) == SEGTREE_OK);
+    assert(st->size == 100);
+    assert(st->capacity == 128);
+    assert(segtree_validate(st));
+
+    int result;
+    for (int left = 0; left < 100; left += 7) {
+        for (int right = left; right < 100; right += 11) {
+            assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+            assert(result == brute_min(values, left, right));
+        }
+    }
+
+    assert(segtree_append_many(st, values, 0) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_append_many(NULL, values, 1) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_append_many(st, NULL, 1) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_destroy(st);
+    printf("Batched append test passed!\n\n");
+}
+
+void test_append_lazy() {
+    printf("Testing appends on a lazy tree...\n");
+
+    int values[40];
+    for (int i = 0; i < 5; i++) {
+        values[i] = i + 1;
+    }
+
+    segment_tree_t *st = segtree_create_lazy(values, 5, SEGTREE_SUM);
+    assert(st != NULL);
+
+    assert(segtree_update_range(st, 0, 4, 10) == SEGTREE_OK);
+    for (int i = 0; i < 5; i++) {
+        values[i] += 10;
+    }
+
+    for (int i = 5; i < 40; i++) {
+        values[i] = i;
+        assert(segtree_append(st, i) == SEGTREE_OK);
+
+        if (i % 6 == 0) {
+            assert(segtree_update_range(st, i / 3, i, 2) == SEGTREE_OK);
+            for (int j = i / 3; j <= i; j++) {
+                values[j] += 2;
+            }
+        }
+    }
+
+    int result;
+    for (int left = 0; left < 40; left += 3) {
+        for (int right = left; right < 40; right += 5) {
+            assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+            assert(result == brute_sum(values, left, right));
+        }
+    }
+
+    assert(segtree_update_point(st, 17, -3) == SEGTREE_OK);
+    values[17] = -3;
+    assert(segtree_query(st, 0, 39, &result) == SEGTREE_OK);
+    assert(result == brute_sum(values, 0, 39));
+
+    segtree_destroy(st);
+    printf("Lazy append test passed!\n\n");
+}
+
+void test_rebuild_diff() {
+    printf("Testing incremental rebuild...\n");
+
+    int n = 1000;
+    int *arr = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        arr[i] = (i * 7) % 101;
+    }
+
+    segment_tree_t *st = segtree_create(arr, n, SEGTREE_MAX);
+    assert(st != NULL);
+
+    arr[3] = 500;
+    arr[517] = -4;
+    arr[999] = 250;
+    assert(segtree_rebuild_diff(st, arr, n) == SEGTREE_OK);
+    assert(segtree_validate(st));
+
+    int result;
+    assert(segtree_query(st, 0, 999, &result) == SEGTREE_OK);
+    assert(result == 500);
+    assert(segtree_query(st, 4, 999, &result) == SEGTREE_OK);
+    assert(result == 250);
+    assert(segtree_query(st, 517, 517, &result) == SEGTREE_OK);
+    assert(result == -4);
+
+    for (int i = 0; i < n; i += 2) {
+        arr[i] = -i;
+    }
+    assert(segtree_rebuild_diff(st, arr, n) == SEGTREE_OK);
+    assert(segtree_validate(st));
+
+    for (int left = 0; left < n; left += 97) {
+        for (int right = left; right < n; right += 89) {
+            int expected = arr[left];
+            for (int i = left; i <= right; i++) {
+                if (arr[i] > expected) {
+                    expected = arr[i];
+                }
+            }
+            assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+            assert(result == expected);
+        }
+    }
+
+    assert(segtree_rebuild_diff(st, arr, 600) == SEGTREE_OK);
+    assert(st->size == 600);
+    assert(segtree_query(st, 0, 599, &result) == SEGTREE_OK);
+    assert(result == 500);
+
+    assert(segtree_rebuild_diff(st, NULL, 600) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_rebuild_diff(st, arr, 0) == SEGTREE_ERROR_INVALID_RANGE);
+
+    segtree_destroy(st);
+    free(arr);
+    printf("Incremental rebuild test passed!\n\n");
+}
+
+void test_bulk_build() {
+    printf("Testing level-by-level bulk build...\n");
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    int sizes[] = {1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 33, 64, 100, 1027};
+    int *arr = (int*)malloc(1027 * sizeof(int));
+    int *other = (int*)malloc(1027 * sizeof(int));
+
+    srand(42);
+    for (int o = 0; o < 3; o++) {
+        for (int s = 0; s < 14; s++) {
+            int n = sizes[s];
+            for (int i = 0; i < n; i++) {
+                arr[i] = (i % 5 == 0) ? SEGTREE_NEG_INF + i : rand() % 2001 - 1000;
+                other[i] = (i % 7 == 0) ? SEGTREE_INF - i : rand() % 2001 - 1000;
+            }
+            if (ops[o] == SEGTREE_SUM) {
+                for (int i = 0; i < n; i++) {
+                    arr[i] %= 100000;
+                    other[i] %= 100000;
+                }
+            }
+
+            segment_tree_t *st = segtree_create(arr, n, ops[o]);
+            assert(st != NULL);
+            assert(segtree_validate(st));
+
+            for (int round = 0; round < 2; round++) {
+                int *data = round == 0 ? arr : other;
+                if (round == 1) {
+                    assert(segtree_rebuild(st, other, n) == SEGTREE_OK);
+                    assert(segtree_validate(st));
+                }
+
+                for (int left = 0; left < n; left += 1 + n / 13) {
+                    int right = n - 1 - (n - 1 - left) / 3;
+                    int expected = data[left];
+                    for (int i = left + 1; i <= right; i++) {
+                        if (ops[o] == SEGTREE_SUM) {
+                            expected += data[i];
+                        } else if (ops[o] == SEGTREE_MIN) {
+                            expected = data[i] < expected ? data[i] : expected;
+                        } else {
+                            expected = data[i] > expected ? data[i] : expected;
+                        }
+                    }
+
+                    int result;
+                    assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+                    assert(result == expected);
+                }
+            }
+
+            segtree_destroy(st);
+        }
+    }
+
+    free(arr);
+    free(other);
+    printf("Bulk build test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Dynamic Tree Tests ===\n\n");
+
+    test_append_single();
+    test_append_many();
+    test_append_lazy();
+    test_rebuild_diff();
+    test_bulk_build();
+
+    printf("=== All Dynamic Tree Tests Passed! ===\n");
+    return 0;
+}
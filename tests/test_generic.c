@@ -0,0 +1,158 @@
+#include "../include/segtree_generic.h"
+#include <assert.h>
+
+typedef struct {
+    long long sum;
+    int count;
+} sum_count_t;
+
+typedef struct {
+    unsigned int m[2][2];
+} mat2_t;
+
+typedef struct {
+    unsigned int modulus;
+    int calls;
+} mat_ctx_t;
+
+static void sum_count_combine(void *ctx, const void *a, const void *b, void *out) {
+    (void)ctx;
+    const sum_count_t *x = (const sum_count_t*)a;
+    const sum_count_t *y = (const sum_count_t*)b;
+    sum_count_t *r = (sum_count_t*)out;
+    r->sum = x->sum + y->sum;
+    r->count = x->count + y->count;
+}
+
+static inline mat2_t mat_mul(void *ctx, mat2_t a, mat2_t b) {
+    mat_ctx_t *c = (mat_ctx_t*)ctx;
+    mat2_t r;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            unsigned long long v = (unsigned long long)a.m[i][0] * b.m[0][j] +
+                                   (unsigned long long)a.m[i][1] * b.m[1][j];
+            r.m[i][j] = (unsigned int)(v % c->modulus);
+        }
+    }
+    c->calls++;
+    return r;
+}
+
+static void mat_combine(void *ctx, const void *a, const void *b, void *out) {
+    *(mat2_t*)out = mat_mul(ctx, *(const mat2_t*)a, *(const mat2_t*)b);
+}
+
+SEGTREE_DEFINE_TYPED(segtree_mat, mat2_t, mat_mul)
+
+static mat2_t random_mat(unsigned int modulus) {
+    mat2_t r;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            r.m[i][j] = (unsigned int)rand() % modulus;
+        }
+    }
+    return r;
+}
+
+static mat2_t naive_product(mat2_t *mats, int left, int right, mat_ctx_t *ctx) {
+    mat2_t r = mats[left];
+    for (int i = left + 1; i <= right; i++) {
+        r = mat_mul(ctx, r, mats[i]);
+    }
+    return r;
+}
+
+void test_generic_struct_aggregate() {
+    printf("Testing generic engine with a (sum, count) struct...\n");
+
+    sum_count_t values[6];
+    for (int i = 0; i < 6; i++) {
+        values[i].sum = (i + 1) * 1000000000LL;
+        values[i].count = 1;
+    }
+    sum_count_t identity = {0, 0};
+
+    segtree_generic_t *st = segtree_generic_create(values, 6, sizeof(sum_count_t), 16,
+                                                   sum_count_combine, NULL, &identity);
+    assert(st != NULL);
+    assert(st->stride == 16);
+    assert(((size_t)st->tree % 16) == 0);
+
+    sum_count_t result;
+    assert(segtree_generic_query(st, 1, 4, &result) == SEGTREE_OK);
+    assert(result.sum == 14000000000LL);
+    assert(result.count == 4);
+
+    sum_count_t value = {-5, 3};
+    assert(segtree_generic_update_point(st, 2, &value) == SEGTREE_OK);
+    assert(segtree_generic_query(st, 0, 5, &result) == SEGTREE_OK);
+    assert(result.sum == 18000000000LL - 5);
+    assert(result.count == 8);
+    assert(segtree_generic_get(st, 2, &result) == SEGTREE_OK);
+    assert(result.sum == -5 && result.count == 3);
+
+    assert(segtree_generic_query(st, 0, 6, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_generic_query(st, 0, 1, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_generic_create(values, 6, sizeof(sum_count_t), 12, sum_count_combine, NULL, &identity) == NULL);
+
+    segtree_generic_destroy(st);
+    printf("Generic struct aggregate test passed!\n\n");
+}
+
+void test_generic_matrix_with_context() {
+    printf("Testing generic and typed engines on non-commutative matrix products...\n");
+
+    int n = 77;
+    mat2_t mats[77];
+    mat_ctx_t ctx = {1000003u, 0};
+    mat2_t identity = {{{1, 0}, {0, 1}}};
+
+    srand(40);
+    for (int i = 0; i < n; i++) {
+        mats[i] = random_mat(ctx.modulus);
+    }
+
+    segtree_generic_t *generic = segtree_generic_create(mats, n, sizeof(mat2_t), sizeof(unsigned int),
+                                                        mat_combine, &ctx, &identity);
+    segtree_mat_t *typed = segtree_mat_create(mats, n, identity, &ctx);
+    assert(generic != NULL);
+    assert(typed != NULL);
+    assert(ctx.calls > 0);
+
+    for (int step = 0; step < 500; step++) {
+        int left = rand() % n;
+        int right = left + rand() % (n - left);
+
+        if (step % 4 == 0) {
+            mat2_t value = random_mat(ctx.modulus);
+            mats[left] = value;
+            assert(segtree_generic_update_point(generic, left, &value) == SEGTREE_OK);
+            assert(segtree_mat_update_point(typed, left, value) == SEGTREE_OK);
+        }
+
+        mat2_t expected = naive_product(mats, left, right, &ctx);
+        mat2_t from_generic, from_typed;
+        assert(segtree_generic_query(generic, left, right, &from_generic) == SEGTREE_OK);
+        assert(segtree_mat_query(typed, left, right, &from_typed) == SEGTREE_OK);
+        assert(memcmp(&expected, &from_generic, sizeof(mat2_t)) == 0);
+        assert(memcmp(&expected, &from_typed, sizeof(mat2_t)) == 0);
+    }
+
+    mat2_t out;
+    assert(segtree_mat_query(typed, 3, 2, &out) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_mat_update_point(typed, n, out) == SEGTREE_ERROR_INVALID_RANGE);
+
+    segtree_mat_destroy(typed);
+    segtree_generic_destroy(generic);
+    printf("Generic matrix test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Generic Segment Tree Tests ===\n\n");
+
+    test_generic_struct_aggregate();
+    test_generic_matrix_with_context();
+
+    printf("=== All Generic Segment Tree Tests Passed! ===\n");
+    return 0;
+}
@@ -161,6 +161,218 @@ void test_lazy_error_handling() {
     printf("Lazy error handling test passed!\n\n");
 }
 
+void test_lazy_randomized() {
+    printf("Testing lazy engine against brute force...\n");
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    int n = 37;
+    int arr[37];
+    int expected_arr[37];
+
+    for (int o = 0; o < 3; o++) {
+        srand(1234 + o);
+        for (int i = 0; i < n; i++) {
+            arr[i] = rand() % 50;
+            expected_arr[i] = arr[i];
+        }
+
+        segment_tree_t *st = segtree_create_lazy(arr, n, ops[o]);
+        assert(st != NULL);
+
+        for (int step = 0; step < 2000; step++) {
+            int left = rand() % n;
+            int right = rand() % n;
+            if (left > right) {
+                int temp = left;
+                left = right;
+                right = temp;
+            }
+
+            int kind = rand() % 3;
+            int value = rand() % 40 - 10;
+
+            if (kind == 0) {
+                assert(segtree_update_range(st, left, right, value) == SEGTREE_OK);
+                for (int i = left; i <= right; i++) {
+                    expected_arr[i] = (ops[o] == SEGTREE_SUM) ? expected_arr[i] + value : value;
+                }
+            } else if (kind == 1) {
+                assert(segtree_update_point(st, left, value) == SEGTREE_OK);
+                expected_arr[left] = value;
+            } else {
+                int expected = expected_arr[left];
+                for (int i = left + 1; i <= right; i++) {
+                    if (ops[o] == SEGTREE_SUM) {
+                        expected += expected_arr[i];
+                    } else if (ops[o] == SEGTREE_MIN) {
+                        expected = expected_arr[i] < expected ? expected_arr[i] : expected;
+                    } else {
+                        expected = expected_arr[i] > expected ? expected_arr[i] : expected;
+                    }
+                }
+
+                int result;
+                assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+                assert(result == expected);
+            }
+
+            if (step % 100 == 0) {
+                assert(segtree_validate(st));
+            }
+        }
+
+        segtree_destroy(st);
+    }
+
+    printf("Lazy engine randomized test passed!\n\n");
+}
+
+void test_lazy_update_ranges() {
+    printf("Testing bulk range updates...\n");
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    int n = 300;
+    int count = 2000;
+    int arr[300];
+    int expected_arr[300];
+    int *lefts = (int*)malloc(count * sizeof(int));
+    int *rights = (int*)malloc(count * sizeof(int));
+    int *values = (int*)malloc(count * sizeof(int));
+
+    for (int o = 0; o < 3; o++) {
+        srand(777 + o);
+        for (int i = 0; i < n; i++) {
+            arr[i] = rand() % 100;
+            expected_arr[i] = arr[i];
+        }
+        for (int i = 0; i < count; i++) {
+            lefts[i] = rand() % n;
+            rights[i] = lefts[i] + rand() % (n - lefts[i]);
+            values[i] = rand() % 40 - 20;
+        }
+
+        segment_tree_t *st = segtree_create_lazy(arr, n, ops[o]);
+        assert(st != NULL);
+        assert(segtree_update_range(st, 10, 200, 3) == SEGTREE_OK);
+        for (int i = 10; i <= 200; i++) {
+            expected_arr[i] = (ops[o] == SEGTREE_SUM) ? expected_arr[i] + 3 : 3;
+        }
+
+        /* A handful of ranges stays lazy; the full batch goes through the rebuild. */
+        int batches[] = {2, count};
+        segtree_bulk_path_t paths[] = {SEGTREE_BULK_LAZY, SEGTREE_BULK_REBUILD};
+        for (int b = 0; b < 2; b++) {
+            segtree_bulk_path_t path;
+            assert(segtree_update_ranges(st, lefts, rights, values, batches[b], &path) == SEGTREE_OK);
+            assert(path == paths[b]);
+
+            for (int i = 0; i < batches[b]; i++) {
+                for (int j = lefts[i]; j <= rights[i]; j++) {
+                    expected_arr[j] = (ops[o] == SEGTREE_SUM) ? expected_arr[j] + values[i] : values[i];
+                }
+            }
+
+            for (int i = 0; i < n; i++) {
+                int result;
+                assert(segtree_query(st, i, i, &result) == SEGTREE_OK);
+                assert(result == expected_arr[i]);
+            }
+            assert(segtree_validate(st));
+        }
+
+        segtree_destroy(st);
+    }
+
+    segment_tree_t *st = segtree_create_lazy(arr, n, SEGTREE_SUM);
+    segtree_bulk_path_t path = SEGTREE_BULK_LAZY;
+    assert(segtree_update_ranges(st, lefts, rights, values, 0, &path) == SEGTREE_OK);
+    assert(path == SEGTREE_BULK_NONE);
+    assert(segtree_update_ranges(st, NULL, rights, values, count, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    rights[3] = n;
+    assert(segtree_update_ranges(st, lefts, rights, values, count, NULL) == SEGTREE_ERROR_INVALID_RANGE);
+    segtree_destroy(st);
+
+    st = segtree_create(arr, n, SEGTREE_SUM);
+    assert(segtree_update_ranges(st, lefts, rights, values, 1, NULL) == SEGTREE_ERROR_INVALID_OPERATION);
+    segtree_destroy(st);
+
+    free(lefts);
+    free(rights);
+    free(values);
+    printf("Bulk range update test passed!\n\n");
+}
+
+void test_lazy_validate_modes() {
+    printf("Testing parallel and sampled validation...\n");
+
+    int n = 300000;
+    int *arr = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        arr[i] = i % 1000;
+    }
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    for (int o = 0; o < 3; o++) {
+        segment_tree_t *st = segtree_create_lazy(arr, n, ops[o]);
+        assert(st != NULL);
+
+        srand(46 + o);
+        for (int i = 0; i < 200; i++) {
+            int left = rand() % n;
+            int right = left + rand() % (n - left);
+            assert(segtree_update_range(st, left, right, rand() % 100 - 50) == SEGTREE_OK);
+        }
+
+        /* Validation must leave pending tags where they are. */
+        size_t bytes = st->tree_size * sizeof(int);
+        int *tree_before = (int*)malloc(bytes);
+        int *lazy_before = (int*)malloc(bytes);
+        memcpy(tree_before, st->tree, bytes);
+        memcpy(lazy_before, st->lazy, bytes);
+
+        assert(segtree_validate(st));
+        assert(segtree_validate_parallel(st, 4));
+        assert(segtree_validate_parallel(st, 0));
+        assert(segtree_validate_sampled(st, 1000, 7));
+        assert(memcmp(tree_before, st->tree, bytes) == 0);
+        assert(memcmp(lazy_before, st->lazy, bytes) == 0);
+
+        /* Corrupt the last internal node: only the tail chunk can see it. */
+        st->tree[st->capacity - 1] ^= 1;
+        assert(!segtree_validate(st));
+        assert(!segtree_validate_parallel(st, 4));
+        st->tree[st->capacity - 1] ^= 1;
+
+        /* The root lies on every sampled path. */
+        st->tree[1] ^= 1;
+        assert(!segtree_validate_sampled(st, 1, 7));
+        assert(!segtree_validate_parallel(st, 3));
+        st->tree[1] ^= 1;
+
+        /* Pending SUM tags sit at every level; the running length must
+         * match each one, whatever the seed. */
+        assert(segtree_validate_sampled(st, 1000, 11));
+        st->tree[2] ^= 1;
+        assert(!segtree_validate_sampled(st, 64, 11));
+        st->tree[2] ^= 1;
+
+        st->tree[st->capacity + n] = 12345;
+        assert(!segtree_validate_parallel(st, 4));
+        st->tree[st->capacity + n] = st->identity;
+        assert(segtree_validate_parallel(st, 4));
+
+        free(tree_before);
+        free(lazy_before);
+        segtree_destroy(st);
+    }
+
+    assert(!segtree_validate_parallel(NULL, 4));
+    assert(!segtree_validate_sampled(NULL, 4, 1));
+
+    free(arr);
+    printf("Validation modes test passed!\n\n");
+}
+
 int main() {
     printf("=== Starting Lazy Propagation Tests ===\n\n");
 
@@ -168,6 +380,9 @@ int main() {
     test_lazy_multiple_updates();
     test_lazy_mixed_operations();
     test_lazy_error_handling();
+    test_lazy_randomized();
+    test_lazy_update_ranges();
+    test_lazy_validate_modes();
 
     printf("=== All Lazy Propagation Tests Passed! ===\n");
     return 0;
@@ -0,0 +1,275 @@
+#define _XOPEN_SOURCE 700
+
+#include "../include/segment_tree.h"
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+
+void test_histogram_buckets() {
+    printf("Testing log-linear histogram buckets...\n");
+
+    segtree_histogram_t hist;
+    memset(&hist, 0, sizeof(hist));
+    assert(segtree_histogram_percentile(&hist, 50.0) == 0);
+
+    for (unsigned long long ns = 1; ns <= 100000; ns++) {
+        segtree_histogram_record(&hist, ns);
+    }
+
+    assert(hist.count == 100000);
+    assert(hist.min_ns == 1);
+    assert(hist.max_ns == 100000);
+    assert(hist.sum_ns == 100000ULL * 100001ULL / 2);
+
+    /* Sixteen buckets per power of two bound the relative error by 1/16. */
+    double percentiles[] = {1.0, 50.0, 90.0, 99.0, 99.9};
+    for (int i = 0; i < 5; i++) {
+        double exact = percentiles[i] * 1000.0;
+        double reported = (double)segtree_histogram_percentile(&hist, percentiles[i]);
+        assert(reported >= exact);
+        assert(reported <= exact * (1.0 + 1.0 / 16.0) + 1.0);
+    }
+    assert(segtree_histogram_percentile(&hist, 100.0) == 100000);
+    assert(segtree_histogram_percentile(&hist, 0.0) == 1);
+
+    /* Small values are exact, huge ones land in the last bucket. */
+    segtree_histogram_t small;
+    memset(&small, 0, sizeof(small));
+    segtree_histogram_record(&small, 7);
+    segtree_histogram_record(&small, 1ULL << 50);
+    assert(small.buckets[7] == 1);
+    assert(small.buckets[SEGTREE_HIST_BUCKETS - 1] == 1);
+    assert(segtree_histogram_percentile(&small, 50.0) == 7);
+
+    /* Merging two halves matches recording everything into one. */
+    segtree_histogram_t even, odd, merged;
+    memset(&even, 0, sizeof(even));
+    memset(&odd, 0, sizeof(odd));
+    memset(&merged, 0, sizeof(merged));
+    for (unsigned long long ns = 1; ns <= 100000; ns++) {
+        segtree_histogram_record((ns & 1) ? &odd : &even, ns);
+    }
+    segtree_histogram_merge(&merged, &even);
+    segtree_histogram_merge(&merged, &odd);
+    assert(memcmp(&merged, &hist, sizeof(hist)) == 0);
+
+    printf("Histogram bucket test passed!\n\n");
+}
+
+#define WORKER_QUERIES 1000
+
+static void* query_worker(void *arg) {
+    (void)arg;
+    int arr[64];
+    for (int i = 0; i < 64; i++) {
+        arr[i] = i;
+    }
+
+    segment_tree_t *st = segtree_create(arr, 64, SEGTREE_SUM);
+    for (int i = 0; i < WORKER_QUERIES; i++) {
+        int result;
+        segtree_query(st, i % 64, 63, &result);
+    }
+    segtree_destroy(st);
+    return NULL;
+}
+
+void test_metrics_per_thread() {
+    printf("Testing per-thread metrics and collection...\n");
+
+    int arr[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    segtree_metrics_t before, local, all;
+    segtree_metrics_collect(&before);
+    segtree_metrics_reset_local();
+
+    segment_tree_t *st = segtree_create_lazy(arr, 8, SEGTREE_SUM);
+    int result;
+    assert(segtree_query(st, 0, 7, &result) == SEGTREE_OK);
+    assert(segtree_update_point(st, 3, 10) == SEGTREE_OK);
+    assert(segtree_update_range(st, 1, 5, 2) == SEGTREE_OK);
+    assert(segtree_update_range(st, 2, 6, 1) == SEGTREE_OK);
+    assert(segtree_rebuild(st, arr, 8) == SEGTREE_OK);
+
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_QUERY].count == 1);
+    assert(local.ops[SEGTREE_PERF_UPDATE_POINT].count == 1);
+    assert(local.ops[SEGTREE_PERF_UPDATE_RANGE].count == 2);
+    assert(local.ops[SEGTREE_PERF_BUILD].count == 2);
+
+    pthread_t workers[4];
+    for (int t = 0; t < 4; t++) {
+        assert(pthread_create(&workers[t], NULL, query_worker, NULL) == 0);
+    }
+    for (int t = 0; t < 4; t++) {
+        pthread_join(workers[t], NULL);
+    }
+
+    /* Worker histograms stay out of this thread's, but exited threads are kept. */
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_QUERY].count == 1);
+
+    segtree_metrics_collect(&all);
+    assert(all.ops[SEGTREE_PERF_QUERY].count >= before.ops[SEGTREE_PERF_QUERY].count + 4 * WORKER_QUERIES + 1);
+    assert(all.ops[SEGTREE_PERF_BUILD].count >= before.ops[SEGTREE_PERF_BUILD].count + 4 + 2);
+
+    segtree_metrics_reset_local();
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_QUERY].count == 0);
+
+    /* Counters no longer wrap at 2^31. */
+    st->stats.query_count = 4294967295ULL;
+    assert(segtree_query(st, 0, 0, &result) == SEGTREE_OK);
+    assert(segtree_get_stats(st).query_count == 4294967296ULL);
+
+    segtree_destroy(st);
+    printf("Per-thread metrics test passed!\n\n");
+}
+
+void test_metrics_cached_and_order_queries() {
+    printf("Testing metrics for cache hits and order statistics...\n");
+
+    int arr[16];
+    for (int i = 0; i < 16; i++) {
+        arr[i] = i % 3;
+    }
+
+    segment_tree_t *st = segtree_create(arr, 16, SEGTREE_SUM);
+    assert(segtree_set_frequency_mode(st, true) == SEGTREE_OK);
+    assert(segtree_cache_enable(st, 64) == SEGTREE_OK);
+    segtree_metrics_reset_local();
+
+    /* The second query is a cache hit and still lands in the histogram. */
+    int result;
+    assert(segtree_query(st, 2, 9, &result) == SEGTREE_OK);
+    assert(segtree_query(st, 2, 9, &result) == SEGTREE_OK);
+    assert(segtree_get_stats(st).cache_hits == 1);
+
+    int index, count;
+    assert(segtree_kth(st, 5, &index) == SEGTREE_OK);
+    assert(segtree_rank(st, 7, &count) == SEGTREE_OK);
+
+    segtree_metrics_t local;
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_QUERY].count == 4);
+    assert(segtree_get_stats(st).query_count == 4);
+
+    segtree_destroy(st);
+    printf("Cached and order query metrics test passed!\n\n");
+}
+
+void test_metrics_batches() {
+    printf("Testing metrics for batch calls...\n");
+
+    int arr[16];
+    for (int i = 0; i < 16; i++) {
+        arr[i] = i % 4;
+    }
+
+    segment_tree_t *st = segtree_create(arr, 16, SEGTREE_SUM);
+    assert(segtree_set_frequency_mode(st, true) == SEGTREE_OK);
+    segtree_metrics_reset_local();
+
+    /* Batches record one amortized sample per item. */
+    int lefts[] = {0, 3, 5, 2, 9};
+    int rights[] = {15, 4, 12, 2, 10};
+    int results[5];
+    assert(segtree_query_batch(st, lefts, rights, results, 5) == SEGTREE_OK);
+
+    int ks[] = {1, 4, 9};
+    int indices[3];
+    assert(segtree_kth_batch(st, ks, indices, 3) == SEGTREE_OK);
+
+    int xs[] = {3, 11};
+    int counts[2];
+    assert(segtree_rank_batch(st, xs, counts, 2) == SEGTREE_OK);
+
+    segtree_range_t ranges[] = {{0, 1}, {2, 7}, {4, 4}, {0, 15}};
+    assert(segtree_query_offline(st, ranges, results, 4) == SEGTREE_OK);
+
+    int points[] = {1, 7, 7, 3, 0, 15};
+    int values[] = {2, 2, 3, 0, 1, 1};
+    assert(segtree_update_points(st, points, values, 6) == SEGTREE_OK);
+    assert(segtree_append_many(st, values, 3) == SEGTREE_OK);
+
+    segtree_metrics_t local;
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_QUERY].count == 14);
+    assert(local.ops[SEGTREE_PERF_UPDATE_POINT].count == 9);
+    segtree_destroy(st);
+
+    st = segtree_create_lazy(arr, 16, SEGTREE_SUM);
+    assert(segtree_update_ranges(st, lefts, rights, values, 4, NULL) == SEGTREE_OK);
+    segtree_metrics_local(&local);
+    assert(local.ops[SEGTREE_PERF_UPDATE_RANGE].count == 4);
+    segtree_destroy(st);
+
+    segtree_histogram_t hist;
+    memset(&hist, 0, sizeof(hist));
+    segtree_histogram_record_batch(&hist, 1003, 4);
+    assert(hist.count == 4);
+    assert(hist.sum_ns == 1003);
+    assert(hist.min_ns == 250 && hist.max_ns == 250);
+
+    printf("Batch metrics test passed!\n\n");
+}
+
+static size_t export_to_string(const segtree_metrics_t *metrics, segtree_export_format_t format,
+                               char *buffer, size_t size) {
+    char path[] = "/tmp/segtree_metrics_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    unlink(path);
+
+    assert(segtree_metrics_export(fd, metrics, format) == SEGTREE_OK);
+    assert(lseek(fd, 0, SEEK_SET) == 0);
+    ssize_t bytes = read(fd, buffer, size - 1);
+    assert(bytes > 0);
+    buffer[bytes] = '\0';
+    close(fd);
+    return (size_t)bytes;
+}
+
+void test_metrics_export() {
+    printf("Testing Prometheus and JSON export...\n");
+
+    segtree_metrics_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    for (int i = 0; i < 100; i++) {
+        segtree_histogram_record(&metrics.ops[SEGTREE_PERF_QUERY], 100 + i);
+    }
+    segtree_histogram_record(&metrics.ops[SEGTREE_PERF_QUERY], 5000);
+
+    static char text[65536];
+    export_to_string(&metrics, SEGTREE_EXPORT_PROMETHEUS, text, sizeof(text));
+    assert(strstr(text, "# TYPE segtree_operation_latency_seconds histogram") != NULL);
+    assert(strstr(text, "segtree_operation_latency_seconds_bucket{op=\"query\",le=\"2.56e-07\"} 100\n") != NULL);
+    assert(strstr(text, "segtree_operation_latency_seconds_bucket{op=\"query\",le=\"+Inf\"} 101\n") != NULL);
+    assert(strstr(text, "segtree_operation_latency_seconds_count{op=\"query\"} 101\n") != NULL);
+    assert(strstr(text, "segtree_operation_latency_seconds_count{op=\"build\"} 0\n") != NULL);
+    assert(strstr(text, "segtree_operation_latency_quantile_seconds{op=\"query\",quantile=\"0.999\"} 5e-06\n") != NULL);
+
+    export_to_string(&metrics, SEGTREE_EXPORT_JSON, text, sizeof(text));
+    assert(text[0] == '{');
+    assert(strstr(text, "\"query\":{\"count\":101,\"sum_ns\":19950,\"min_ns\":100,\"max_ns\":5000,") != NULL);
+    assert(strstr(text, "\"p999_ns\":5000") != NULL);
+    assert(strstr(text, "[4864,5120,1]") != NULL);
+    assert(strstr(text, "\"build\":{\"count\":0,") != NULL);
+
+    assert(segtree_metrics_export(1, NULL, SEGTREE_EXPORT_JSON) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_metrics_export(-1, &metrics, SEGTREE_EXPORT_JSON) == SEGTREE_ERROR_INVALID_RANGE);
+
+    printf("Metrics export test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Metrics Tests ===\n\n");
+
+    test_histogram_buckets();
+    test_metrics_per_thread();
+    test_metrics_cached_and_order_queries();
+    test_metrics_batches();
+    test_metrics_export();
+
+    printf("=== All Metrics Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "../include/segtree_packed.h"
+#include <assert.h>
+
+static int naive_range(int *arr, int left, int right, segtree_operation_t op) {
+    int result = arr[left];
+    for (int i = left + 1; i <= right; i++) {
+        if (op == SEGTREE_SUM) {
+            result = (int)((unsigned int)result + (unsigned int)arr[i]);
+        } else if (op == SEGTREE_MIN) {
+            result = arr[i] < result ? arr[i] : result;
+        } else {
+            result = arr[i] > result ? arr[i] : result;
+        }
+    }
+    return result;
+}
+
+void test_packed_memory() {
+    printf("Testing packed leaf memory footprint...\n");
+
+    int n = 100000;
+    int *arr = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        arr[i] = 1000 + rand() % 256;
+    }
+
+    segtree_packed_t *pt = segtree_packed_create(arr, n, SEGTREE_SUM);
+    assert(pt != NULL);
+
+    segment_tree_t *st = segtree_create(arr, n, SEGTREE_SUM);
+    size_t plain = sizeof(segment_tree_t) + (size_t)st->tree_size * sizeof(int);
+    size_t packed = segtree_packed_memory_usage(pt);
+    printf("plain: %zu bytes, packed: %zu bytes\n", plain, packed);
+    assert(packed * 4 < plain);
+
+    int expected, result;
+    segtree_query(st, 17, 99001, &expected);
+    assert(segtree_packed_query(pt, 17, 99001, &result) == SEGTREE_OK);
+    assert(result == expected);
+
+    /* Widening every block moves its deltas within the shared arena. */
+    for (int i = 0; i < n; i += SEGTREE_PACKED_BLOCK) {
+        assert(segtree_packed_update_point(pt, i, -500000) == SEGTREE_OK);
+        segtree_update_point(st, i, -500000);
+    }
+    assert(segtree_packed_memory_usage(pt) > packed);
+    assert(pt->arena_used <= pt->arena_capacity);
+    segtree_query(st, 17, 99001, &expected);
+    assert(segtree_packed_query(pt, 17, 99001, &result) == SEGTREE_OK);
+    assert(result == expected);
+
+    segtree_destroy(st);
+    segtree_packed_destroy(pt);
+    free(arr);
+    printf("Packed memory test passed!\n\n");
+}
+
+void test_packed_randomized() {
+    printf("Testing packed queries and updates against a naive array...\n");
+
+    int sizes[] = {1, 63, 64, 65, 1000};
+    int spreads[] = {1, 200, 70000, 0};
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    int arr[1000];
+
+    srand(37);
+    for (int o = 0; o < 3; o++) {
+        for (int s = 0; s < 5; s++) {
+            for (int v = 0; v < 4; v++) {
+                int n = sizes[s];
+                for (int i = 0; i < n; i++) {
+                    arr[i] = spreads[v] ? rand() % spreads[v] - spreads[v] / 3 : (int)(((unsigned int)rand() << 1) ^ (unsigned int)rand());
+                }
+
+                segtree_packed_t *pt = segtree_packed_create(arr, n, ops[o]);
+                assert(pt != NULL);
+
+                for (int step = 0; step < 400; step++) {
+                    int left = rand() % n;
+                    int right = left + rand() % (n - left);
+
+                    if (step % 4 == 0) {
+                        int value = (step % 8 == 0) ? arr[right] + 1 : (int)(((unsigned int)rand() << 1) ^ (unsigned int)rand());
+                        if (v == 0 && step % 16 == 4) {
+                            value = SEGTREE_NEG_INF;
+                        }
+                        assert(segtree_packed_update_point(pt, right, value) == SEGTREE_OK);
+                        arr[right] = value;
+                    }
+
+                    int result;
+                    assert(segtree_packed_query(pt, left, right, &result) == SEGTREE_OK);
+                    assert(result == naive_range(arr, left, right, ops[o]));
+
+                    assert(segtree_packed_get(pt, left, &result) == SEGTREE_OK);
+                    assert(result == arr[left]);
+                }
+
+                segtree_packed_destroy(pt);
+            }
+        }
+    }
+
+    int small[] = {1, 2, 3};
+    segtree_packed_t *pt = segtree_packed_create(small, 3, SEGTREE_SUM);
+    int result;
+    assert(segtree_packed_query(pt, 0, 3, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_packed_query(pt, 0, 2, NULL) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_packed_update_point(pt, -1, 0) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_packed_create(small, 3, SEGTREE_CUSTOM) == NULL);
+    segtree_packed_destroy(pt);
+
+    printf("Packed randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Packed Leaf Tests ===\n\n");
+
+    test_packed_memory();
+    test_packed_randomized();
+
+    printf("=== All Packed Leaf Tests Passed! ===\n");
+    return 0;
+}
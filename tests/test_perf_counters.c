@@ -0,0 +1,82 @@
+#include "../include/segment_tree.h"
+#include <assert.h>
+
+void test_perf_disabled_by_default() {
+    printf("Testing perf counters are off by default...\n");
+
+    int arr[] = {1, 2, 3, 4};
+    segment_tree_t *st = segtree_create(arr, 4, SEGTREE_SUM);
+    assert(st != NULL);
+
+    int result;
+    assert(segtree_query(st, 0, 3, &result) == SEGTREE_OK);
+
+    segtree_stats_t stats = segtree_get_stats(st);
+    for (int op = 0; op < SEGTREE_PERF_OP_COUNT; op++) {
+        assert(stats.perf[op].samples == 0);
+    }
+
+    segtree_perf_disable(st);
+    segtree_destroy(st);
+    printf("Perf disabled test passed!\n\n");
+}
+
+void test_perf_sampling() {
+    printf("Testing perf counter sampling...\n");
+
+    int arr[256];
+    for (int i = 0; i < 256; i++) {
+        arr[i] = i;
+    }
+
+    segment_tree_t *st = segtree_create_lazy(arr, 256, SEGTREE_SUM);
+    assert(st != NULL);
+
+    assert(segtree_perf_enable(NULL) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_error_t error = segtree_perf_enable(st);
+    if (error != SEGTREE_OK) {
+        printf("perf_event_open unavailable here, skipping sampling checks\n");
+        assert(st->perf == NULL);
+        segtree_destroy(st);
+        printf("Perf sampling test passed!\n\n");
+        return;
+    }
+
+    int result;
+    for (int i = 0; i < 10; i++) {
+        assert(segtree_query(st, i, 200, &result) == SEGTREE_OK);
+        assert(segtree_update_point(st, i, i * 2) == SEGTREE_OK);
+    }
+    assert(segtree_update_range(st, 3, 99, 1) == SEGTREE_OK);
+    assert(segtree_rebuild(st, arr, 256) == SEGTREE_OK);
+
+    segtree_stats_t stats = segtree_get_stats(st);
+    assert(stats.perf[SEGTREE_PERF_QUERY].samples == 10);
+    assert(stats.perf[SEGTREE_PERF_UPDATE_POINT].samples == 10);
+    assert(stats.perf[SEGTREE_PERF_UPDATE_RANGE].samples == 1);
+    assert(stats.perf[SEGTREE_PERF_BUILD].samples == 1);
+    assert(stats.perf[SEGTREE_PERF_QUERY].instructions > 0);
+
+    segtree_print_stats(st);
+
+    segtree_reset_stats(st);
+    stats = segtree_get_stats(st);
+    assert(stats.perf[SEGTREE_PERF_QUERY].samples == 0);
+
+    segtree_perf_disable(st);
+    assert(st->perf == NULL);
+
+    segtree_destroy(st);
+    printf("Perf sampling test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Perf Counter Tests ===\n\n");
+
+    test_perf_disabled_by_default();
+    test_perf_sampling();
+
+    printf("=== All Perf Counter Tests Passed! ===\n");
+    return 0;
+}
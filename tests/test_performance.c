@@ -64,7 +64,7 @@ void test_query_performance() {
     printf("Average query time: %.9f seconds\n", query_time / PERFORMANCE_QUERIES);
 
     segtree_stats_t stats = segtree_get_stats(st);
-    printf("Statistics - Queries: %d, Total time: %.6f\n",
+    printf("Statistics - Queries: %llu, Total time: %.6f\n",
            stats.query_count, stats.total_query_time);
 
     segtree_destroy(st);
@@ -97,7 +97,7 @@ void test_update_performance() {
     printf("Average update time: %.9f seconds\n", update_time / PERFORMANCE_QUERIES);
 
     segtree_stats_t stats = segtree_get_stats(st);
-    printf("Statistics - Updates: %d, Total time: %.6f\n",
+    printf("Statistics - Updates: %llu, Total time: %.6f\n",
            stats.update_count, stats.total_update_time);
 
     segtree_destroy(st);
@@ -147,7 +147,7 @@ void test_lazy_performance() {
     printf("Total lazy operations time: %.6f seconds\n", lazy_time);
 
     segtree_stats_t stats = segtree_get_stats(st);
-    printf("Statistics - Queries: %d, Updates: %d\n",
+    printf("Statistics - Queries: %llu, Updates: %llu\n",
            stats.query_count, stats.update_count);
 
     segtree_destroy(st);
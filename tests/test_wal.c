@@ -0,0 +1,337 @@
+#define _XOPEN_SOURCE 700
+
+#include "../include/segment_tree.h"
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static void temp_paths(char *log_path, char *snapshot_path) {
+    strcpy(log_path, "/tmp/segtree_wal_XXXXXX");
+    int fd = mkstemp(log_path);
+    assert(fd >= 0);
+    close(fd);
+    strcpy(snapshot_path, log_path);
+    strcat(snapshot_path, ".snap");
+}
+
+static long long file_size(const char *path) {
+    struct stat info;
+    assert(stat(path, &info) == 0);
+    return (long long)info.st_size;
+}
+
+static void assert_contents(segment_tree_t *st, int *expected, int n) {
+    assert(st->size == n);
+    for (int i = 0; i < n; i++) {
+        int result;
+        assert(segtree_query(st, i, i, &result) == SEGTREE_OK);
+        assert(result == expected[i]);
+    }
+    assert(segtree_validate(st));
+}
+
+void test_wal_recovery() {
+    printf("Testing WAL replay after a crash...\n");
+
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    char log_path[64];
+    char snapshot_path[64];
+    int n = 200;
+    int capacity = 400;
+    int *arr = (int*)malloc(capacity * sizeof(int));
+    int *expected = (int*)malloc(capacity * sizeof(int));
+    int indices[4], values[4], lefts[4], rights[4];
+
+    for (int o = 0; o < 3; o++) {
+        srand(45 + o);
+        for (int i = 0; i < n; i++) {
+            arr[i] = rand() % 100;
+            expected[i] = arr[i];
+        }
+        int size = n;
+
+        temp_paths(log_path, snapshot_path);
+        segment_tree_t *st = segtree_create_lazy(arr, n, ops[o]);
+        assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 8, 64) == SEGTREE_OK);
+
+        for (int step = 0; step < 500; step++) {
+            int kind = rand() % 5;
+            if (kind == 0) {
+                int index = rand() % size;
+                int value = rand() % 100;
+                assert(segtree_update_point(st, index, value) == SEGTREE_OK);
+                expected[index] = value;
+            } else if (kind == 1 || kind == 2) {
+                int k = (kind == 1) ? 1 : 4;
+                for (int i = 0; i < k; i++) {
+                    lefts[i] = rand() % size;
+                    rights[i] = lefts[i] + rand() % (size - lefts[i]);
+                    values[i] = rand() % 20 - 10;
+                    for (int j = lefts[i]; j <= rights[i]; j++) {
+                        expected[j] = (ops[o] == SEGTREE_SUM) ? expected[j] + values[i] : values[i];
+                    }
+                }
+                if (k == 1) {
+                    assert(segtree_update_range(st, lefts[0], rights[0], values[0]) == SEGTREE_OK);
+                } else {
+                    assert(segtree_update_ranges(st, lefts, rights, values, k, NULL) == SEGTREE_OK);
+                }
+            } else if (kind == 3) {
+                for (int i = 0; i < 4; i++) {
+                    indices[i] = rand() % size;
+                    values[i] = rand() % 100;
+                    expected[indices[i]] = values[i];
+                }
+                assert(segtree_update_points(st, indices, values, 4) == SEGTREE_OK);
+            } else if (size < capacity) {
+                int value = rand() % 100;
+                assert(segtree_append(st, value) == SEGTREE_OK);
+                expected[size++] = value;
+            }
+        }
+
+        /* Periodic checkpoints keep the log short. */
+        assert(file_size(log_path) < 2 * 64 * 32);
+
+        /* Crash: recover from the files while the original tree is still open. */
+        assert(segtree_wal_sync(st) == SEGTREE_OK);
+        segment_tree_t *recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 8, 64);
+        assert(recovered != NULL);
+        assert(recovered->lazy_enabled);
+        assert_contents(recovered, expected, size);
+
+        /* The recovered tree keeps logging where the old one stopped. */
+        assert(segtree_update_point(recovered, 3, 77) == SEGTREE_OK);
+        expected[3] = 77;
+        segtree_destroy(recovered);
+        recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 8, 0);
+        assert(recovered != NULL);
+        assert_contents(recovered, expected, size);
+
+        segtree_destroy(recovered);
+        segtree_destroy(st);
+        unlink(log_path);
+        unlink(snapshot_path);
+    }
+
+    free(arr);
+    free(expected);
+    printf("WAL recovery test passed!\n\n");
+}
+
+void test_wal_group_commit_and_torn_tail() {
+    printf("Testing WAL group commit and torn records...\n");
+
+    char log_path[64];
+    char snapshot_path[64];
+    int arr[16] = {0};
+    int expected[16] = {0};
+    temp_paths(log_path, snapshot_path);
+
+    segment_tree_t *st = segtree_create(arr, 16, SEGTREE_SUM);
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_NONE, 100, 0) == SEGTREE_OK);
+    assert(file_size(log_path) == 0);
+
+    /* Without the time bound, only a full group or an explicit sync commits. */
+    assert(segtree_wal_set_group_delay(st, 0) == SEGTREE_OK);
+
+    for (int i = 0; i < 10; i++) {
+        assert(segtree_update_point(st, i, i + 1) == SEGTREE_OK);
+        expected[i] = i + 1;
+    }
+
+    /* Nothing reaches the file until the group commits. */
+    assert(file_size(log_path) == 0);
+    assert(segtree_wal_sync(st) == SEGTREE_OK);
+    long long committed = file_size(log_path);
+    assert(committed > 0);
+
+    /* A half-written record at the tail is dropped and cut off. */
+    int fd = open(log_path, O_WRONLY | O_APPEND);
+    assert(fd >= 0);
+    char garbage[13];
+    memset(garbage, 0x5a, sizeof(garbage));
+    assert(write(fd, garbage, sizeof(garbage)) == (ssize_t)sizeof(garbage));
+    close(fd);
+
+    segment_tree_t *recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert(file_size(log_path) == committed);
+    assert_contents(recovered, expected, 16);
+
+    /* A checkpoint folds the log into the snapshot. */
+    assert(segtree_update_point(recovered, 15, 9) == SEGTREE_OK);
+    expected[15] = 9;
+    assert(file_size(log_path) > committed);
+    assert(segtree_wal_checkpoint(recovered) == SEGTREE_OK);
+    assert(file_size(log_path) == 0);
+    segtree_destroy(recovered);
+
+    recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert_contents(recovered, expected, 16);
+    segtree_destroy(recovered);
+
+    /* Records already covered by the snapshot are skipped. */
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0) == SEGTREE_OK);
+    assert(segtree_update_point(st, 0, 50) == SEGTREE_OK);
+    fd = open(log_path, O_RDONLY);
+    char stale[256];
+    ssize_t stale_bytes = read(fd, stale, sizeof(stale));
+    assert(stale_bytes > 0);
+    close(fd);
+    assert(segtree_wal_checkpoint(st) == SEGTREE_OK);
+    segtree_destroy(st);
+
+    fd = open(log_path, O_WRONLY | O_APPEND);
+    assert(write(fd, stale, (size_t)stale_bytes) == stale_bytes);
+    close(fd);
+
+    int expected_after[16];
+    memcpy(expected_after, expected, sizeof(expected));
+    expected_after[0] = 50;
+    expected_after[15] = 0;
+    recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert_contents(recovered, expected_after, 16);
+    segtree_destroy(recovered);
+
+    unlink(log_path);
+    unlink(snapshot_path);
+    printf("WAL group commit test passed!\n\n");
+}
+
+void test_wal_group_delay() {
+    printf("Testing WAL group commit time bound...\n");
+
+    char log_path[64];
+    char snapshot_path[64];
+    int arr[8] = {0};
+    int expected[8] = {0};
+    temp_paths(log_path, snapshot_path);
+
+    /* A group far larger than the write rate still reaches disk on time. */
+    segment_tree_t *st = segtree_create(arr, 8, SEGTREE_SUM);
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 1000, 0) == SEGTREE_OK);
+    assert(segtree_wal_set_group_delay(st, 5) == SEGTREE_OK);
+
+    for (int i = 0; i < 3; i++) {
+        assert(segtree_update_point(st, i, 10 + i) == SEGTREE_OK);
+        expected[i] = 10 + i;
+    }
+
+    struct timespec pause = {0, 10000000};
+    for (int wait = 0; wait < 200 && file_size(log_path) < 3 * 32; wait++) {
+        nanosleep(&pause, NULL);
+    }
+    assert(file_size(log_path) == 3 * 32);
+
+    /* Crash without a sync: the delayed commit already made them durable. */
+    segment_tree_t *recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert_contents(recovered, expected, 8);
+    segtree_destroy(recovered);
+
+    segtree_destroy(st);
+    assert(segtree_wal_set_group_delay(NULL, 5) == SEGTREE_ERROR_NULL_POINTER);
+
+    unlink(log_path);
+    unlink(snapshot_path);
+    printf("WAL group delay test passed!\n\n");
+}
+
+void test_wal_write_buffer() {
+    printf("Testing WAL with a write buffer...\n");
+
+    char log_path[64];
+    char snapshot_path[64];
+    int arr[16] = {0};
+    int expected[16] = {0};
+    temp_paths(log_path, snapshot_path);
+
+    segment_tree_t *st = segtree_create_lazy(arr, 16, SEGTREE_SUM);
+    assert(segtree_write_buffer_enable(st, 64) == SEGTREE_OK);
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 5) == SEGTREE_OK);
+
+    /* Buffered writes are logged on acceptance, so they survive a crash
+     * before any flush; the small checkpoint interval flushes mid-stream. */
+    for (int i = 0; i < 12; i++) {
+        assert(segtree_update_point(st, i, 10 * i) == SEGTREE_OK);
+        expected[i] = 10 * i;
+        assert(segtree_update_range(st, i, i + 4, 1) == SEGTREE_OK);
+        for (int j = i; j <= i + 4; j++) {
+            expected[j] += 1;
+        }
+    }
+    assert(st->write_buffer->point_count + st->write_buffer->range_count > 0);
+
+    segment_tree_t *recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert_contents(recovered, expected, 16);
+    segtree_destroy(recovered);
+
+    /* A checkpoint applies the buffer first; discarded writes after it must
+     * not come back on replay. */
+    assert(segtree_wal_checkpoint(st) == SEGTREE_OK);
+    assert(st->write_buffer->point_count + st->write_buffer->range_count == 0);
+    assert(segtree_update_point(st, 15, 999) == SEGTREE_OK);
+    assert(segtree_update_range(st, 0, 15, 1000) == SEGTREE_OK);
+    segtree_write_buffer_discard(st);
+
+    recovered = segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_EACH, 4, 0);
+    assert(recovered != NULL);
+    assert_contents(recovered, expected, 16);
+    segtree_destroy(recovered);
+
+    assert_contents(st, expected, 16);
+    segtree_destroy(st);
+
+    unlink(log_path);
+    unlink(snapshot_path);
+    printf("WAL write buffer test passed!\n\n");
+}
+
+static int combine_or(int a, int b) {
+    return a | b;
+}
+
+void test_wal_errors() {
+    printf("Testing WAL error handling...\n");
+
+    char log_path[64];
+    char snapshot_path[64];
+    int arr[4] = {1, 2, 3, 4};
+    temp_paths(log_path, snapshot_path);
+
+    segment_tree_t *st = segtree_create_custom(arr, 4, combine_or, 0);
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 4, 0) == SEGTREE_ERROR_INVALID_OPERATION);
+    segtree_destroy(st);
+
+    st = segtree_create(arr, 4, SEGTREE_SUM);
+    assert(segtree_wal_enable(NULL, log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 4, 0) == SEGTREE_ERROR_NULL_POINTER);
+    assert(segtree_wal_enable(st, log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 0, 0) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_wal_enable(st, log_path, "/nonexistent/dir/snap", SEGTREE_WAL_SYNC_GROUP, 4, 0) == SEGTREE_ERROR_IO);
+    assert(segtree_wal_sync(st) == SEGTREE_OK);
+    assert(segtree_wal_checkpoint(st) == SEGTREE_OK);
+    segtree_destroy(st);
+
+    assert(segtree_wal_recover(log_path, snapshot_path, SEGTREE_WAL_SYNC_GROUP, 4, 0) == NULL);
+
+    unlink(log_path);
+    printf("WAL error handling test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Write-Ahead Log Tests ===\n\n");
+
+    test_wal_recovery();
+    test_wal_group_commit_and_torn_tail();
+    test_wal_group_delay();
+    test_wal_write_buffer();
+    test_wal_errors();
+
+    printf("=== All Write-Ahead Log Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "../include/segtree_wavelet.h"
+#include <assert.h>
+
+static int compare_ints(const void *a, const void *b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+void test_wavelet_small() {
+    printf("Testing wavelet k-th smallest and count...\n");
+
+    int arr[] = {5, 1, 4, 1, 3, 9, 2, 6};
+    segtree_wavelet_t *wt = segtree_wavelet_create(arr, 8);
+    assert(wt != NULL);
+
+    int result;
+    assert(segtree_wavelet_kth_smallest(wt, 0, 7, 1, &result) == SEGTREE_OK);
+    assert(result == 1);
+    assert(segtree_wavelet_kth_smallest(wt, 0, 7, 2, &result) == SEGTREE_OK);
+    assert(result == 1);
+    assert(segtree_wavelet_kth_smallest(wt, 0, 7, 8, &result) == SEGTREE_OK);
+    assert(result == 9);
+    assert(segtree_wavelet_kth_smallest(wt, 2, 5, 2, &result) == SEGTREE_OK);
+    assert(result == 3);
+
+    assert(segtree_wavelet_count_leq(wt, 0, 7, 3, &result) == SEGTREE_OK);
+    assert(result == 4);
+    assert(segtree_wavelet_count_leq(wt, 2, 5, 0, &result) == SEGTREE_OK);
+    assert(result == 0);
+    assert(segtree_wavelet_count_leq(wt, 2, 5, 100, &result) == SEGTREE_OK);
+    assert(result == 4);
+
+    assert(segtree_wavelet_kth_smallest(wt, 2, 5, 5, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_wavelet_count_leq(wt, 3, 8, 1, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_wavelet_count_leq(wt, 0, 1, 1, NULL) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_wavelet_destroy(wt);
+    printf("Wavelet small test passed!\n\n");
+}
+
+void test_wavelet_randomized() {
+    printf("Testing wavelet queries against sorted slices...\n");
+
+    int sizes[] = {1, 7, 64, 65, 300};
+    int ranges[] = {1, 3, 50, 1000000};
+    int arr[300];
+    int slice[300];
+
+    srand(35);
+    for (int s = 0; s < 5; s++) {
+        for (int v = 0; v < 4; v++) {
+            int n = sizes[s];
+            for (int i = 0; i < n; i++) {
+                arr[i] = rand() % ranges[v] - ranges[v] / 2;
+            }
+
+            segtree_wavelet_t *wt = segtree_wavelet_create(arr, n);
+            assert(wt != NULL);
+
+            for (int q = 0; q < 200; q++) {
+                int left = rand() % n;
+                int right = left + rand() % (n - left);
+                int len = right - left + 1;
+
+                memcpy(slice, arr + left, len * sizeof(int));
+                qsort(slice, len, sizeof(int), compare_ints);
+
+                int k = 1 + rand() % len;
+                int result;
+                assert(segtree_wavelet_kth_smallest(wt, left, right, k, &result) == SEGTREE_OK);
+                assert(result == slice[k - 1]);
+
+                int x = slice[rand() % len] + (rand() % 3) - 1;
+                int expected = 0;
+                for (int i = 0; i < len; i++) {
+                    expected += slice[i] <= x;
+                }
+                assert(segtree_wavelet_count_leq(wt, left, right, x, &result) == SEGTREE_OK);
+                assert(result == expected);
+            }
+
+            segtree_wavelet_destroy(wt);
+        }
+    }
+
+    printf("Wavelet randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Wavelet Tree Tests ===\n\n");
+
+    test_wavelet_small();
+    test_wavelet_randomized();
+
+    printf("=== All Wavelet Tree Tests Passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "../include/segtree_window.h"
+#include <assert.h>
+
+void test_window_basic() {
+    printf("Testing sliding window push and query...\n");
+
+    segtree_window_t *wt = segtree_window_create(3, SEGTREE_SUM);
+    assert(wt != NULL);
+
+    int result;
+    assert(segtree_window_query(wt, 1, &result) == SEGTREE_ERROR_INVALID_RANGE);
+
+    assert(segtree_window_push(wt, 5) == SEGTREE_OK);
+    assert(segtree_window_push(wt, 7) == SEGTREE_OK);
+    assert(segtree_window_query(wt, 2, &result) == SEGTREE_OK);
+    assert(result == 12);
+    assert(segtree_window_query(wt, 3, &result) == SEGTREE_ERROR_INVALID_RANGE);
+
+    assert(segtree_window_push(wt, 1) == SEGTREE_OK);
+    assert(segtree_window_push(wt, 10) == SEGTREE_OK);     /* evicts 5 */
+    assert(segtree_window_query(wt, 3, &result) == SEGTREE_OK);
+    assert(result == 18);
+    assert(segtree_window_query(wt, 1, &result) == SEGTREE_OK);
+    assert(result == 10);
+    assert(segtree_window_query(wt, 4, &result) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_window_query(wt, 1, NULL) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_window_destroy(wt);
+    assert(segtree_window_create(0, SEGTREE_SUM) == NULL);
+    printf("Sliding window basic test passed!\n\n");
+}
+
+void test_window_randomized() {
+    printf("Testing sliding window against a naive history...\n");
+
+    int windows[] = {1, 2, 5, 8, 13, 64, 100};
+    segtree_operation_t ops[] = {SEGTREE_SUM, SEGTREE_MIN, SEGTREE_MAX};
+    static int history[5000];
+
+    srand(39);
+    for (int o = 0; o < 3; o++) {
+        for (int w = 0; w < 7; w++) {
+            segtree_window_t *wt = segtree_window_create(windows[w], ops[o]);
+            assert(wt != NULL);
+
+            for (int pushed = 0; pushed < 5000; pushed++) {
+                history[pushed] = rand() % 2001 - 1000;
+                assert(segtree_window_push(wt, history[pushed]) == SEGTREE_OK);
+
+                int available = pushed + 1 < windows[w] ? pushed + 1 : windows[w];
+                int k = 1 + rand() % available;
+
+                int expected = history[pushed];
+                for (int i = pushed - 1; i > pushed - k; i--) {
+                    if (ops[o] == SEGTREE_SUM) {
+                        expected += history[i];
+                    } else if (ops[o] == SEGTREE_MIN) {
+                        expected = history[i] < expected ? history[i] : expected;
+                    } else {
+                        expected = history[i] > expected ? history[i] : expected;
+                    }
+                }
+
+                int result;
+                assert(segtree_window_query(wt, k, &result) == SEGTREE_OK);
+                assert(result == expected);
+            }
+
+            segtree_window_destroy(wt);
+        }
+    }
+
+    printf("Sliding window randomized test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Sliding Window Tests ===\n\n");
+
+    test_window_basic();
+    test_window_randomized();
+
+    printf("=== All Sliding Window Tests Passed! ===\n");
+    return 0;
+}
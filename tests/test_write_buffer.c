@@ -0,0 +1,154 @@
+#include "../include/segment_tree.h"
+#include <assert.h>
+
+static int brute_sum(int *arr, int left, int right) {
+    int sum = 0;
+    for (int i = left; i <= right; i++) {
+        sum += arr[i];
+    }
+    return sum;
+}
+
+void test_update_points() {
+    printf("Testing bulk point updates...\n");
+
+    int arr[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    segment_tree_t *st = segtree_create(arr, 10, SEGTREE_MAX);
+    assert(st != NULL);
+
+    int indices[] = {7, 2, 7, 0};
+    int values[] = {50, 40, -1, 30};
+    assert(segtree_update_points(st, indices, values, 4) == SEGTREE_OK);
+    assert(segtree_validate(st));
+
+    int result;
+    assert(segtree_query(st, 0, 9, &result) == SEGTREE_OK);
+    assert(result == 40);
+    assert(segtree_query(st, 7, 7, &result) == SEGTREE_OK);
+    assert(result == -1);
+    assert(segtree_query(st, 0, 1, &result) == SEGTREE_OK);
+    assert(result == 30);
+
+    indices[1] = 10;
+    assert(segtree_update_points(st, indices, values, 4) == SEGTREE_ERROR_INVALID_RANGE);
+    assert(segtree_update_points(st, NULL, values, 4) == SEGTREE_ERROR_NULL_POINTER);
+
+    segtree_destroy(st);
+    printf("Bulk point update test passed!\n\n");
+}
+
+void test_write_buffer_coalescing() {
+    printf("Testing write buffer coalescing...\n");
+
+    int arr[16] = {0};
+    segment_tree_t *st = segtree_create(arr, 16, SEGTREE_SUM);
+    assert(st != NULL);
+    assert(segtree_write_buffer_enable(st, 64) == SEGTREE_OK);
+
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 16; i++) {
+            assert(segtree_update_point(st, i, round * 10 + i) == SEGTREE_OK);
+            arr[i] = round * 10 + i;
+        }
+    }
+
+    segtree_stats_t stats = segtree_get_stats(st);
+    assert(stats.update_count == 80);
+    assert(stats.coalesced_writes == 64);
+    assert(stats.buffer_flushes == 0);
+    assert(st->write_buffer->point_count == 16);
+
+    int result;
+    assert(segtree_query(st, 0, 15, &result) == SEGTREE_OK);
+    assert(result == brute_sum(arr, 0, 15));
+
+    stats = segtree_get_stats(st);
+    assert(stats.buffer_flushes == 1);
+    assert(stats.update_count == 80);
+    assert(st->write_buffer->point_count == 0);
+
+    segtree_destroy(st);
+    printf("Write buffer coalescing test passed!\n\n");
+}
+
+void test_write_buffer_mixed() {
+    printf("Testing write buffer with range adds...\n");
+
+    int n = 200;
+    int arr[200];
+    for (int i = 0; i < n; i++) {
+        arr[i] = i % 9;
+    }
+
+    segment_tree_t *st = segtree_create_lazy(arr, n, SEGTREE_SUM);
+    assert(st != NULL);
+    assert(segtree_write_buffer_enable(st, 32) == SEGTREE_OK);
+    assert(segtree_cache_enable(st, 64) == SEGTREE_OK);
+
+    int result;
+    srand(7);
+    for (int step = 0; step < 3000; step++) {
+        int left = rand() % n;
+        int right = left + rand() % (n - left);
+        int kind = rand() % 4;
+
+        if (kind == 0) {
+            int value = rand() % 21 - 10;
+            assert(segtree_update_range(st, left, right, value) == SEGTREE_OK);
+            for (int i = left; i <= right; i++) {
+                arr[i] += value;
+            }
+        } else if (kind == 1 || kind == 2) {
+            int value = rand() % 100;
+            assert(segtree_update_point(st, left, value) == SEGTREE_OK);
+            arr[left] = value;
+        } else {
+            assert(segtree_query(st, left, right, &result) == SEGTREE_OK);
+            assert(result == brute_sum(arr, left, right));
+        }
+    }
+
+    segtree_write_buffer_disable(st);
+    assert(st->write_buffer == NULL);
+    assert(segtree_validate(st));
+    assert(segtree_query(st, 0, n - 1, &result) == SEGTREE_OK);
+    assert(result == brute_sum(arr, 0, n - 1));
+
+    assert(segtree_write_buffer_enable(st, 0) == SEGTREE_ERROR_INVALID_RANGE);
+
+    segtree_destroy(st);
+    printf("Write buffer range add test passed!\n\n");
+}
+
+void test_write_buffer_rebuild_discards() {
+    printf("Testing rebuild discards buffered writes...\n");
+
+    int arr[] = {1, 1, 1, 1};
+    segment_tree_t *st = segtree_create(arr, 4, SEGTREE_SUM);
+    assert(st != NULL);
+    assert(segtree_write_buffer_enable(st, 8) == SEGTREE_OK);
+
+    assert(segtree_update_point(st, 2, 100) == SEGTREE_OK);
+
+    int fresh[] = {2, 2, 2, 2};
+    assert(segtree_rebuild(st, fresh, 4) == SEGTREE_OK);
+
+    int result;
+    assert(segtree_query(st, 0, 3, &result) == SEGTREE_OK);
+    assert(result == 8);
+
+    segtree_destroy(st);
+    printf("Rebuild discard test passed!\n\n");
+}
+
+int main() {
+    printf("=== Starting Write Buffer Tests ===\n\n");
+
+    test_update_points();
+    test_write_buffer_coalescing();
+    test_write_buffer_mixed();
+    test_write_buffer_rebuild_discards();
+
+    printf("=== All Write Buffer Tests Passed! ===\n");
+    return 0;
+}